@@ -28,10 +28,13 @@
 #include "Config.h"
 #include "DockRegistry_p.h"
 #include "FrameworkWidgetFactory.h"
+#include "FloatingWindowPool_p.h"
+#include "HibernationManager_p.h"
 
 #include <QApplication>
 #include <QDebug>
 #include <QOperatingSystemVersion>
+#include <QScreen>
 
 using namespace KDDockWidgets;
 
@@ -55,6 +58,11 @@ public:
     FrameworkWidgetFactory *m_frameworkWidgetFactory;
     Flags m_flags = Flag_Default;
     int m_separatorThickness = 5;
+    int m_dragHoverInterval = -1;
+    int m_floatingWindowPoolSize = 0;
+    int m_maxPlaceholdersPerLayout = -1;
+    int m_tabHibernationTimeout = -1;
+    qint64 m_maxInactiveTabsMemory = -1;
 #if defined(Q_OS_WIN)
     int m_staticSeparatorThickness = 1; // FIXME: Broken on Windows still.
 #else
@@ -142,6 +150,70 @@ void Config::setSeparatorThickness(int value, bool staticSeparator)
         d->m_separatorThickness = value;
 }
 
+void Config::setDragHoverInterval(int ms)
+{
+    d->m_dragHoverInterval = ms < 0 ? -1 : ms;
+}
+
+int Config::dragHoverInterval() const
+{
+    if (d->m_dragHoverInterval >= 0)
+        return d->m_dragHoverInterval;
+
+    // One frame of the primary screen
+    const QScreen *screen = qApp ? QGuiApplication::primaryScreen() : nullptr;
+    const qreal refreshRate = screen ? screen->refreshRate() : 0;
+    return refreshRate > 0 ? qMax(1, qRound(1000 / refreshRate)) : 16;
+}
+
+void Config::setFloatingWindowPoolSize(int size)
+{
+    if (size < 0) {
+        qWarning() << Q_FUNC_INFO << "Invalid value" << size;
+        return;
+    }
+
+    d->m_floatingWindowPoolSize = size;
+    FloatingWindowPool::self()->setMaxSize(size);
+}
+
+int Config::floatingWindowPoolSize() const
+{
+    return d->m_floatingWindowPoolSize;
+}
+
+void Config::setMaxPlaceholdersPerLayout(int max)
+{
+    d->m_maxPlaceholdersPerLayout = max < 0 ? -1 : max;
+}
+
+int Config::maxPlaceholdersPerLayout() const
+{
+    return d->m_maxPlaceholdersPerLayout;
+}
+
+void Config::setTabHibernationTimeout(int msecs)
+{
+    d->m_tabHibernationTimeout = msecs < 0 ? -1 : msecs;
+    HibernationManager::self()->onSettingsChanged();
+}
+
+int Config::tabHibernationTimeout() const
+{
+    return d->m_tabHibernationTimeout;
+}
+
+void Config::setMaxInactiveTabsMemory(qint64 bytes)
+{
+    d->m_maxInactiveTabsMemory = bytes < 0 ? -1 : bytes;
+    HibernationManager::self()->onSettingsChanged();
+}
+
+qint64 Config::maxInactiveTabsMemory() const
+{
+    return d->m_maxInactiveTabsMemory;
+}
+
 void Config::setQmlEngine(QQmlEngine *qmlEngine)
 {
     if (d->m_qmlEngine) {
@@ -183,4 +255,9 @@ void Config::Private::fixFlags()
 #if !defined(Q_OS_WIN) && !defined(Q_OS_MACOS)
     m_flags = m_flags & ~Flag_AeroSnapWithClientDecos;
 #endif
+
+#if defined(KDDOCKWIDGETS_QTQUICK)
+    // Only QtWidgets can paint the separators from the MultiSplitter
+    m_flags = m_flags & ~Flag_LightweightSeparators;
+#endif
 }
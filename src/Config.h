@@ -69,6 +69,8 @@ public:
         Flag_LazyResize = 32, /// The dock widgets are resized in a lazy manner. The actual resize only happens when you release the mouse button.
         Flag_TabsHaveCloseButton = 64, /// Tabs will have a close button. Equivalent to QTabWidget::setTabsClosable(true).
         Flag_DoubleClickMaximizes = 128, /// Double clicking the titlebar will maximize a floating window instead of re-docking it
+        Flag_LightweightSeparators = 256, /// Separators don't get a QWidget each. The MultiSplitter paints them and handles their mouse events itself. Scales better with many dock widgets. Only supported with QtWidgets.
+        Flag_CoalesceResizes = 512, /// While the window is being resized the layout is only redone once per event loop iteration, with the latest size, instead of on every resize event.
         Flag_Default = Flag_AeroSnapWithClientDecos ///> The defaults
     };
     Q_DECLARE_FLAGS(Flags, Flag)
@@ -131,6 +133,71 @@ public:
     ///Note: Only use this function at startup before creating any DockWidget or MainWindow.
     void setSeparatorThickness(int value, bool staticSeparator);
 
+    /**
+     * @brief Sets the minimum interval, in milliseconds, between drop indicator updates while dragging.
+     *
+     * Mouse moves are coalesced, so hit testing and drop indicator updates run at most once per interval.
+     * The dragged window itself always follows the mouse immediately, and the release position is
+     * always honoured exactly.
+     *
+     * 0 updates on every mouse move. A negative value restores the default, which is the duration
+     * of one frame of the primary screen.
+     */
+    void setDragHoverInterval(int ms);
+
+    ///@brief getter for @ref setDragHoverInterval. Returns the effective interval, never negative.
+    int dragHoverInterval() const;
+
+    /**
+     * @brief Keeps up to @p size hidden FloatingWindows pre-constructed, so dock widgets can be torn
+     * off without constructing a window from scratch.
+     *
+     * Emptied floating windows are also returned to the pool instead of being deleted.
+     * Default is 0, which disables the pool. Only supported with QtWidgets.
+     */
+    void setFloatingWindowPoolSize(int size);
+
+    ///@brief getter for @ref setFloatingWindowPoolSize
+    int floatingWindowPoolSize() const;
+
+    /**
+     * @brief Sets the maximum number of placeholders each layout keeps.
+     *
+     * Closing a docked dock widget leaves a placeholder behind, so it can be restored to the same
+     * place later. When a layout has more than @p max placeholders the least recently used ones are
+     * removed, together with the separators they leave unneeded. Those dock widgets will no longer
+     * remember their docked position.
+     * Default is -1, which means no limit.
+     */
+    void setMaxPlaceholdersPerLayout(int max);
+
+    ///@brief getter for @ref setMaxPlaceholdersPerLayout
+    int maxPlaceholdersPerLayout() const;
+
+    /**
+     * @brief Sets how long, in milliseconds, a dock widget can be a non-current tab before hibernating.
+     *
+     * Only applies to dock widgets that opted in via DockWidgetBase::setHibernationCallbacks(),
+     * which can override it with DockWidgetBase::setHibernationTimeout().
+     * Default is -1, which means they only hibernate to honour @ref setMaxInactiveTabsMemory.
+     */
+    void setTabHibernationTimeout(int msecs);
+
+    ///@brief getter for @ref setTabHibernationTimeout
+    int tabHibernationTimeout() const;
+
+    /**
+     * @brief Sets how much memory, in bytes, the non-current tabs can hold before hibernating.
+     *
+     * The memory is the sum of DockWidgetBase::memoryCost() of the awake, non-current tabs that can
+     * hibernate. When over budget, the least recently used ones hibernate first.
+     * Default is -1, which means no limit.
+     */
+    void setMaxInactiveTabsMemory(qint64 bytes);
+
+    ///@brief getter for @ref setMaxInactiveTabsMemory
+    qint64 maxInactiveTabsMemory() const;
+
     ///@brief Sets the QQmlEngine to use. Applicable only when using QtQuick.
     void setQmlEngine(QQmlEngine *);
     QQmlEngine* qmlEngine() const;
@@ -22,6 +22,7 @@
 #include "DragController_p.h"
 #include "Frame_p.h"
 #include "FloatingWindow_p.h"
+#include "FloatingWindowPool_p.h"
 #include "Logging_p.h"
 #include "TabWidget_p.h"
 #include "Utils_p.h"
@@ -32,6 +33,7 @@
 #include "multisplitter/Item_p.h"
 #include "Config.h"
 #include "FrameworkWidgetFactory.h"
+#include "HibernationManager_p.h"
 
 #include <QAction>
 #include <QEvent>
@@ -98,11 +100,20 @@ public:
      */
     void saveTabIndex();
 
+    void hibernate();
+    void wakeUp();
+
     const QString name;
     QString affinityName;
     QString title;
     QIcon icon;
     QWidget *widget = nullptr;
+    DockWidgetBase::WidgetFactory widgetFactory;
+    DockWidgetBase::HibernationCallback hibernateCallback;
+    DockWidgetBase::HibernationCallback wakeUpCallback;
+    int hibernationTimeout = -1;
+    qint64 memoryCost = 0;
+    bool isHibernating = false;
     DockWidgetBase *const q;
     DockWidgetBase::Options options;
     QAction *const toggleAction;
@@ -126,6 +137,8 @@ DockWidgetBase::DockWidgetBase(const QString &name, Options options)
 
 DockWidgetBase::~DockWidgetBase()
 {
+    if (canHibernate())
+        HibernationManager::self()->untrack(this);
     DockRegistry::self()->unregisterDockWidget(this);
     qCDebug(creation) << "~DockWidget" << this;
     delete d;
@@ -200,6 +213,7 @@ void DockWidgetBase::setWidget(QWidget *w)
     qCDebug(addwidget) << Q_FUNC_INFO << w;
 
     d->widget = w;
+    d->widgetFactory = nullptr;
     Q_EMIT widgetChanged(w);
     setWindowTitle(uniqueName());
 }
@@ -209,6 +223,35 @@ QWidget *DockWidgetBase::widget() const
     return d->widget;
 }
 
+void DockWidgetBase::setWidgetFactory(const WidgetFactory &factory)
+{
+    if (d->widget) {
+        qWarning() << Q_FUNC_INFO << "Dock widget already has a widget" << uniqueName();
+        return;
+    }
+
+    d->widgetFactory = factory;
+}
+
+QWidget *DockWidgetBase::ensureWidget()
+{
+    if (d->widget || !d->widgetFactory)
+        return d->widget;
+
+    qCDebug(addwidget) << Q_FUNC_INFO << "Creating widget for" << uniqueName();
+
+    // Move it out first, so we don't recurse if the factory shows us
+    const WidgetFactory factory = std::move(d->widgetFactory);
+    d->widgetFactory = nullptr;
+    if (QWidget *w = factory()) {
+        setWidget(w);
+    } else {
+        qWarning() << Q_FUNC_INFO << "Widget factory returned nullptr for" << uniqueName();
+    }
+
+    return d->widget;
+}
+
 bool DockWidgetBase::isFloating() const
 {
     if (isWindow())
@@ -353,6 +396,65 @@ QString DockWidgetBase::affinityName() const
     return d->affinityName;
 }
 
+void DockWidgetBase::setHibernationCallbacks(const HibernationCallback &hibernate,
+                                             const HibernationCallback &wakeUp)
+{
+    if (!hibernate && canHibernate()) {
+        HibernationManager::self()->wakeUp(this);
+        HibernationManager::self()->untrack(this);
+    }
+
+    d->hibernateCallback = hibernate;
+    d->wakeUpCallback = wakeUp;
+
+    if (canHibernate())
+        HibernationManager::self()->track(this);
+}
+
+bool DockWidgetBase::isHibernating() const
+{
+    return d->isHibernating;
+}
+
+void DockWidgetBase::setHibernationTimeout(int msecs)
+{
+    d->hibernationTimeout = msecs < 0 ? -1 : msecs;
+    if (canHibernate())
+        HibernationManager::self()->onSettingsChanged();
+}
+
+int DockWidgetBase::hibernationTimeout() const
+{
+    return d->hibernationTimeout;
+}
+
+void DockWidgetBase::setMemoryCost(qint64 bytes)
+{
+    d->memoryCost = qMax<qint64>(0, bytes);
+    if (canHibernate())
+        HibernationManager::self()->onSettingsChanged();
+}
+
+qint64 DockWidgetBase::memoryCost() const
+{
+    return d->memoryCost;
+}
+
+bool DockWidgetBase::canHibernate() const
+{
+    return bool(d->hibernateCallback);
+}
+
+void DockWidgetBase::hibernate()
+{
+    d->hibernate();
+}
+
+void DockWidgetBase::wakeUp()
+{
+    d->wakeUp();
+}
+
 void DockWidgetBase::show()
 {
     if (isWindow() && (lastPosition()->m_wasFloating || !lastPosition()->isValid())) {
@@ -411,7 +513,7 @@ FloatingWindow *DockWidgetBase::morphIntoFloatingWindow()
 
         auto frame = Config::self().frameworkWidgetFactory()->createFrame();
         frame->addWidget(this);
-        auto floatingWindow = Config::self().frameworkWidgetFactory()->createFloatingWindow(frame);
+        auto floatingWindow = FloatingWindowPool::self()->floatingWindowFor(frame);
         floatingWindow->setGeometry(geo);
         floatingWindow->show();
 
@@ -597,6 +699,29 @@ void DockWidgetBase::Private::show()
     q->show();
 }
 
+void DockWidgetBase::Private::hibernate()
+{
+    if (isHibernating || !hibernateCallback || !widget)
+        return;
+
+    qCDebug(hiding) << Q_FUNC_INFO << name;
+    isHibernating = true;
+    hibernateCallback(widget);
+    Q_EMIT q->hibernationChanged(true);
+}
+
+void DockWidgetBase::Private::wakeUp()
+{
+    if (!isHibernating)
+        return;
+
+    qCDebug(hiding) << Q_FUNC_INFO << name;
+    isHibernating = false;
+    if (wakeUpCallback)
+        wakeUpCallback(widget);
+    Q_EMIT q->hibernationChanged(false);
+}
+
 void DockWidgetBase::onParentChanged()
 {
     Q_EMIT parentChanged();
@@ -605,6 +730,9 @@ void DockWidgetBase::onParentChanged()
 
 void DockWidgetBase::onShown(bool spontaneous)
 {
+    ensureWidget();
+    if (d->isHibernating)
+        HibernationManager::self()->wakeUp(this);
     Q_EMIT shown();
 
     if (Frame *f = frame()) {
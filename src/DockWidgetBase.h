@@ -36,6 +36,8 @@
 #include <QVector>
 #include <QWidget>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 class QAction;
 QT_END_NAMESPACE
@@ -52,6 +54,7 @@ class LayoutSaver;
 class TabWidget;
 class TitleBar;
 class MainWindowBase;
+class HibernationManager;
 
 /**
  * @brief The DockWidget base-class. DockWidget and DockWidgetBase are only
@@ -66,6 +69,12 @@ class DOCKS_EXPORT DockWidgetBase : public QWidgetOrQuick
 public:
     typedef QVector<DockWidgetBase *> List;
 
+    ///@brief A function that creates the hosted widget on demand. @sa setWidgetFactory()
+    typedef std::function<QWidget*()> WidgetFactory;
+
+    ///@brief A function called with the hosted widget when hibernating or waking up. @sa setHibernationCallbacks()
+    typedef std::function<void(QWidget*)> HibernationCallback;
+
     ///@brief DockWidget options to pass at construction time
     enum Option {
         Option_None = 0, ///< No option, the default
@@ -129,9 +138,32 @@ public:
 
     /**
      * @brief returns the widget which this dock widget hosts
+     *
+     * Returns nullptr if a widget factory was set and the dock widget hasn't been shown yet.
+     * @sa setWidgetFactory()
      */
     QWidget *widget() const;
 
+    /**
+     * @brief Sets a factory that creates the hosted widget lazily, instead of calling setWidget().
+     *
+     * The factory is called once, the first time the dock widget is shown or becomes the current
+     * tab, and its result is passed to setWidget(). Dock widgets that start closed, or as hidden
+     * tabs, or that are restored by @ref LayoutSaver into a non-current tab, won't pay for the
+     * construction of their widget until the user actually sees them.
+     *
+     * @param factory the function creating the widget. Must not return nullptr.
+     * @sa ensureWidget()
+     */
+    void setWidgetFactory(const WidgetFactory &factory);
+
+    /**
+     * @brief Creates the hosted widget now if a widget factory was set and wasn't called yet.
+     * @return the hosted widget, which might be nullptr if there's neither widget nor factory.
+     * @sa setWidgetFactory()
+     */
+    QWidget *ensureWidget();
+
     /**
      * @brief Returns whether the dock widget is floating.
      * Floating means it's not docked and has a window of its own.
@@ -263,6 +295,43 @@ public:
      */
     QString affinityName() const;
 
+    /**
+     * @brief Opts this dock widget into hibernation.
+     *
+     * When the dock widget has been a non-current tab for longer than its hibernation timeout, or
+     * the inactive tabs use more memory than allowed, @p hibernate is called with the hosted widget
+     * so it can release its heavy state. @p wakeUp is called when it becomes the current tab again,
+     * or is shown, so the state can be rebuilt.
+     *
+     * Pass null functions to opt out.
+     * @sa Config::setTabHibernationTimeout(), Config::setMaxInactiveTabsMemory(), setMemoryCost()
+     */
+    void setHibernationCallbacks(const HibernationCallback &hibernate, const HibernationCallback &wakeUp);
+
+    ///@brief Returns whether the hibernate callback was called and wakeUp wasn't yet
+    bool isHibernating() const;
+
+    /**
+     * @brief Sets how long this dock widget can be a non-current tab before hibernating.
+     *
+     * Default is -1, which uses Config::tabHibernationTimeout().
+     */
+    void setHibernationTimeout(int msecs);
+
+    ///@brief getter for @ref setHibernationTimeout
+    int hibernationTimeout() const;
+
+    /**
+     * @brief Sets an estimate of the memory, in bytes, that hibernating would release.
+     *
+     * Used to account for the memory held by inactive tabs and to honour
+     * Config::setMaxInactiveTabsMemory(). Default is 0.
+     */
+    void setMemoryCost(qint64 bytes);
+
+    ///@brief getter for @ref setMemoryCost
+    qint64 memoryCost() const;
+
     /// @brief Equivalent to QWidget::show(), but it's optimized to reduce flickering on some platforms
     void show();
 
@@ -294,6 +363,10 @@ Q_SIGNALS:
     ///@brief emitted when the hosted widget changed
     void widgetChanged(QWidget*);
 
+    ///@brief emitted when the dock widget hibernates or wakes up
+    ///@sa setHibernationCallbacks(), isHibernating()
+    void hibernationChanged(bool hibernating);
+
     ///@brief emitted when the options change
     ///@sa setOptions(), options()
     void optionsChanged(Options);
@@ -336,6 +409,7 @@ private:
     friend class KDDockWidgets::Item;
     friend class KDDockWidgets::DockRegistry;
     friend class KDDockWidgets::LayoutSaver;
+    friend class KDDockWidgets::HibernationManager;
 
     /**
      * @brief the Frame which contains this dock widgets.
@@ -361,6 +435,15 @@ private:
     ///@brief returns the last position, just for tests. TODO Make tests just use the d-pointer.
     LastPosition *lastPosition() const;
 
+    ///@brief returns whether hibernation callbacks were set
+    bool canHibernate() const;
+
+    ///@brief calls the hibernate callback, used by HibernationManager
+    void hibernate();
+
+    ///@brief calls the wake up callback, used by HibernationManager
+    void wakeUp();
+
     class Private;
     Private *const d;
 };
@@ -63,6 +63,11 @@ namespace KDDockWidgets
         RestoreOption_None = 0,
         RestoreOption_RelativeToMainWindow = 1, ///< Skips restoring the main window geometry and the restored dock widgets will use relative sizing.
                                                 ///< Loading layouts won't change the main window geometry and just use whatever the user has at the moment.
+        RestoreOption_Incremental = 2, ///< Main windows whose saved layout has the same structure (same frames with the same dock widgets, same separators) as the current one
+                                       ///< are restored in place, only their sizes change. Their frames and separators are reused instead of being destroyed and recreated.
+                                       ///< Main windows that differ have their layout rebuilt, but keep the frames still showing the same dock widgets, whose dock widgets aren't closed.
+                                       ///< Floating windows are always recreated, but such frames move into the new ones too.
+                                       ///< Only the frames that differ are created, deleted or moved.
     };
     Q_DECLARE_FLAGS(RestoreOptions, RestoreOption)
 
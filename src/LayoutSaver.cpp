@@ -36,6 +36,7 @@
 #include "LastPosition_p.h"
 #include "multisplitter/Anchor_p.h"
 #include "multisplitter/Item_p.h"
+#include "multisplitter/MultiSplitterLayout_p.h"
 #include "FrameworkWidgetFactory.h"
 
 #include <qmath.h>
@@ -43,13 +44,34 @@
 #include <QSettings>
 #include <QApplication>
 #include <QFile>
+#include <QThread>
 
 #include <memory>
 
 using namespace KDDockWidgets;
 
-QHash<QString, LayoutSaver::DockWidget::Ptr> LayoutSaver::DockWidget::s_dockWidgets;
-LayoutSaver::Layout* LayoutSaver::Layout::s_currentLayoutBeingRestored = nullptr;
+thread_local LayoutSaver::Layout* LayoutSaver::Layout::s_currentLayoutBeingRestored = nullptr;
+
+namespace {
+///@brief Reads and parses a layout file, for LayoutSaver::restoreFromFileAsync()
+class LayoutParserThread : public QThread
+{
+public:
+    explicit LayoutParserThread(const QString &filename, QObject *parent)
+        : QThread(parent)
+        , m_filename(filename)
+    {
+    }
+
+    void run() override
+    {
+        m_layout = LayoutSaver::parseLayoutFile(m_filename);
+    }
+
+    const QString m_filename;
+    std::shared_ptr<LayoutSaver::Layout> m_layout;
+};
+}
 
 static QVariantMap sizeToMap(QSize sz)
 {
@@ -85,6 +107,46 @@ static QRect mapToRect(const QVariantMap &map)
                  map.value(QStringLiteral("height")).toInt());
 }
 
+template <typename T>
+static void writeList(QDataStream &ds, const QVector<T> &list)
+{
+    ds << qint32(list.size());
+    for (const T &t : list)
+        t.toDataStream(ds);
+}
+
+template <typename T>
+static void readList(QDataStream &ds, QVector<T> &list)
+{
+    qint32 count = 0;
+    ds >> count;
+    list.clear();
+    for (int i = 0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        T t;
+        t.fromDataStream(ds);
+        list.push_back(t);
+    }
+}
+
+static void writeDockWidgetNames(QDataStream &ds, const LayoutSaver::DockWidget::List &list)
+{
+    ds << qint32(list.size());
+    for (const auto &dw : list)
+        ds << dw->uniqueName;
+}
+
+static void readDockWidgetNames(QDataStream &ds, LayoutSaver::DockWidget::List &list)
+{
+    qint32 count = 0;
+    ds >> count;
+    list.clear();
+    for (int i = 0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        QString name;
+        ds >> name;
+        list.push_back(LayoutSaver::DockWidget::dockWidgetForName(name));
+    }
+}
+
 class KDDockWidgets::LayoutSaver::Private
 {
 public:
@@ -115,6 +177,8 @@ public:
 
     template <typename T>
     void deserializeWindowGeometry(const T &saved, QWidgetOrQuick *topLevel);
+    MainWindowBase::List mainWindowsToRestoreInPlace(const LayoutSaver::Layout &) const;
+    Frame::List framesToReuse(const LayoutSaver::Layout &, const MainWindowBase::List &mainWindowsToReuse) const;
     void deleteEmptyFrames();
     void clearRestoredProperty();
 
@@ -137,9 +201,9 @@ LayoutSaver::~LayoutSaver()
     delete d;
 }
 
-bool LayoutSaver::saveToFile(const QString &jsonFilename)
+bool LayoutSaver::saveToFile(const QString &jsonFilename, Format format)
 {
-    const QByteArray data = serializeLayout();
+    const QByteArray data = serializeLayout(format);
 
     QFile f(jsonFilename);
     if (!f.open(QIODevice::WriteOnly)) {
@@ -165,7 +229,72 @@ bool LayoutSaver::restoreFromFile(const QString &jsonFilename)
     return result;
 }
 
-QByteArray LayoutSaver::serializeLayout() const
+void LayoutSaver::restoreFromFileAsync(const QString &filename, QObject *context,
+                                       const std::function<void(bool)> &callback)
+{
+    if (!context) {
+        qWarning() << Q_FUNC_INFO << "context can't be null";
+        return;
+    }
+
+    // Owned by qApp, so it's never destroyed while still parsing
+    auto thread = new LayoutParserThread(filename, qApp);
+    const RestoreOptions options = d->m_restoreOptions;
+    const QStringList affinityNames = d->m_affinityNames;
+
+    // QThread::finished is emitted in the worker thread, context lives in the GUI thread, so this is queued
+    QObject::connect(thread, &QThread::finished, context, [thread, options, affinityNames, callback] {
+        bool result = false;
+        if (thread->m_layout) {
+            LayoutSaver saver(options);
+            saver.d->m_affinityNames = affinityNames;
+            result = saver.restoreParsedLayout(thread->m_layout);
+        }
+
+        if (callback)
+            callback(result);
+    });
+
+    QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, thread, [thread] {
+        thread->wait();
+    });
+    thread->start();
+}
+
+std::shared_ptr<LayoutSaver::Layout> LayoutSaver::parseLayout(const QByteArray &data)
+{
+    auto layout = std::make_shared<LayoutSaver::Layout>();
+    if (LayoutSaver::Layout::isBinary(data)) {
+        if (!layout->fromBinary(data)) {
+            qWarning() << Q_FUNC_INFO << "Failed to parse binary data";
+            return {};
+        }
+    } else if (!layout->fromJson(data)) {
+        qWarning() << Q_FUNC_INFO << "Failed to parse json data";
+        return {};
+    }
+
+    if (!layout->isValid()) {
+        qWarning() << Q_FUNC_INFO << "Invalid layout";
+        return {};
+    }
+
+    return layout;
+}
+
+std::shared_ptr<LayoutSaver::Layout> LayoutSaver::parseLayoutFile(const QString &filename)
+{
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning() << Q_FUNC_INFO << "Failed to open" << filename << f.errorString();
+        return {};
+    }
+
+    return parseLayout(f.readAll());
+}
+
+QByteArray LayoutSaver::serializeLayout(Format format) const
 {
     if (!d->m_dockRegistry->isSane()) {
         qWarning() << Q_FUNC_INFO << "Refusing to serialize this layout. Check previous warnings.";
@@ -212,14 +341,32 @@ QByteArray LayoutSaver::serializeLayout() const
         }
     }
 
-    return layout.toJson();
+    return format == Format_Binary ? layout.toBinary()
+                                   : layout.toJson();
 }
 
 bool LayoutSaver::restoreLayout(const QByteArray &data)
 {
-    d->clearRestoredProperty();
-    if (data.isEmpty())
+    if (data.isEmpty()) {
+        d->clearRestoredProperty();
         return true;
+    }
+
+    const std::shared_ptr<LayoutSaver::Layout> layout = parseLayout(data);
+    if (!layout)
+        return false;
+
+    return restoreParsedLayout(layout);
+}
+
+bool LayoutSaver::restoreParsedLayout(const std::shared_ptr<LayoutSaver::Layout> &parsedLayout)
+{
+    if (!parsedLayout) {
+        qWarning() << Q_FUNC_INFO << "Null layout";
+        return false;
+    }
+
+    d->clearRestoredProperty();
 
     struct EnsureItemsAtCorrectPlace {
 
@@ -256,6 +403,7 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
 
         ~FrameCleanup()
         {
+            m_saver->d->m_dockRegistry->releaseFramesToReuse();
             m_saver->d->deleteEmptyFrames();
         }
 
@@ -263,17 +411,41 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
     };
 
     FrameCleanup cleanup(this);
-    LayoutSaver::Layout layout;
-    if (!layout.fromJson(data)) {
-        qWarning() << Q_FUNC_INFO << "Failed to parse json data";
-        return false;
-    }
+    LayoutSaver::Layout &layout = *parsedLayout;
 
+    // Scaling stays in the GUI thread, as it needs the current geometry of the main windows
     if (d->m_restoreOptions & RestoreOption_RelativeToMainWindow)
         layout.scaleSizes();
 
+    // With RestoreOption_Incremental, main windows that only changed sizes are restored in place,
+    // while the others keep the frames whose dock widgets didn't change
+    const MainWindowBase::List mainWindowsToReuse = d->mainWindowsToRestoreInPlace(layout);
+    const Frame::List framesToReuse = d->framesToReuse(layout, mainWindowsToReuse);
+
+    // Clearing the placeholder info can leave placeholder items unreferenced, which would delete
+    // them. Keep the reused layouts intact until the placeholder info is restored in step 4.
+    struct ItemRefs {
+        ~ItemRefs()
+        {
+            for (const QPointer<Item> &item : qAsConst(items)) {
+                if (item)
+                    item->unref();
+            }
+        }
+
+        QVector<QPointer<Item>> items;
+    };
+
+    ItemRefs reusedItems;
+    for (MainWindowBase *mainWindow : mainWindowsToReuse) {
+        for (Item *item : mainWindow->multiSplitterLayout()->items()) {
+            item->ref();
+            reusedItems.items.push_back(item);
+        }
+    }
+
     // Hide all dockwidgets and unparent them from any layout before starting restore
-    d->m_dockRegistry->clear(d->m_affinityNames, /*deleteStaticAnchors=*/true);
+    d->m_dockRegistry->clear(d->m_affinityNames, mainWindowsToReuse, framesToReuse, /*deleteStaticAnchors=*/true);
 
     // 1. Restore main windows
     for (const LayoutSaver::MainWindow &mw : qAsConst(layout.mainWindows)) {
@@ -289,8 +461,12 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
         if (!(d->m_restoreOptions & RestoreOption_RelativeToMainWindow))
             d->deserializeWindowGeometry(mw, mainWindow->window()); // window(), as the MainWindow can be embedded
 
-        if (!mainWindow->deserialize(mw))
+        if (mainWindowsToReuse.contains(mainWindow)) {
+            if (!mainWindow->multiSplitterLayout()->deserializeInPlace(mw.multiSplitterLayout))
+                return false;
+        } else if (!mainWindow->deserialize(mw)) {
             return false;
+        }
     }
 
     // 2. Restore FloatingWindows
@@ -371,6 +547,77 @@ void LayoutSaver::Private::deserializeWindowGeometry(const T &saved, QWidgetOrQu
     topLevel->setVisible(saved.isVisible);
 }
 
+MainWindowBase::List LayoutSaver::Private::mainWindowsToRestoreInPlace(const LayoutSaver::Layout &layout) const
+{
+    MainWindowBase::List result;
+    if (!(m_restoreOptions & RestoreOption_Incremental))
+        return result;
+
+    for (const LayoutSaver::MainWindow &mw : qAsConst(layout.mainWindows)) {
+        MainWindowBase *mainWindow = m_dockRegistry->mainWindowByName(mw.uniqueName);
+        if (!mainWindow || !matchesAffinity(mainWindow->affinityName()))
+            continue;
+
+        if (mw.options != mainWindow->options() || mw.affinityName != mainWindow->affinityName())
+            continue;
+
+        if (mainWindow->multiSplitterLayout()->matchesStructure(mw.multiSplitterLayout))
+            result.push_back(mainWindow);
+    }
+
+    return result;
+}
+
+Frame::List LayoutSaver::Private::framesToReuse(const LayoutSaver::Layout &layout, const MainWindowBase::List &mainWindowsToReuse) const
+{
+    Frame::List result;
+    if (!(m_restoreOptions & RestoreOption_Incremental))
+        return result;
+
+    QVector<const LayoutSaver::Frame *> savedFrames;
+    auto addSavedFrames = [&savedFrames] (const LayoutSaver::MultiSplitterLayout &msl) {
+        for (const LayoutSaver::Item &item : msl.items) {
+            if (!item.frame.isNull && !item.frame.dockWidgets.isEmpty())
+                savedFrames.push_back(&item.frame);
+        }
+    };
+
+    for (const LayoutSaver::MainWindow &mw : qAsConst(layout.mainWindows))
+        addSavedFrames(mw.multiSplitterLayout);
+    for (const LayoutSaver::FloatingWindow &fw : qAsConst(layout.floatingWindows))
+        addSavedFrames(fw.multiSplitterLayout);
+
+    // Each saved frame can be matched by one live frame at most
+    auto addLiveFrames = [&result, &savedFrames] (MultiSplitterLayout *layout) {
+        for (Item *item : layout->items()) {
+            Frame *frame = item->frame();
+            if (item->isPlaceholder() || !frame || frame->beingDeletedLater())
+                continue;
+
+            for (int i = 0; i < savedFrames.size(); ++i) {
+                if (frame->hasSameDockWidgets(*savedFrames.at(i))) {
+                    result.push_back(frame);
+                    savedFrames.removeAt(i);
+                    break;
+                }
+            }
+        }
+    };
+
+    for (MainWindowBase *mainWindow : m_dockRegistry->mainwindows()) {
+        if (!mainWindowsToReuse.contains(mainWindow) && matchesAffinity(mainWindow->affinityName()))
+            addLiveFrames(mainWindow->multiSplitterLayout());
+    }
+
+    // Floating windows are always recreated, but their frames can move into the new ones
+    for (FloatingWindow *fw : m_dockRegistry->nestedwindows()) {
+        if (!fw->beingDeleted() && matchesAffinity(fw->affinityName()))
+            addLiveFrames(fw->multiSplitterLayout());
+    }
+
+    return result;
+}
+
 void LayoutSaver::Private::deleteEmptyFrames()
 {
     // After a restore it can happen that some DockWidgets didn't exist, so weren't restored.
@@ -448,6 +695,59 @@ bool LayoutSaver::Layout::fromJson(const QByteArray &jsonData)
     return false;
 }
 
+QByteArray LayoutSaver::Layout::toBinary() const
+{
+    QByteArray data;
+    QDataStream ds(&data, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_9);
+    ds << quint32(KDDOCKWIDGETS_BINARY_MAGIC) << quint32(KDDOCKWIDGETS_BINARY_FORMAT_VERSION);
+    toDataStream(ds);
+
+    return data;
+}
+
+bool LayoutSaver::Layout::fromBinary(const QByteArray &data)
+{
+    QDataStream ds(data);
+    ds.setVersion(QDataStream::Qt_5_9);
+
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    ds >> magic >> formatVersion;
+    if (magic != KDDOCKWIDGETS_BINARY_MAGIC) {
+        qWarning() << Q_FUNC_INFO << "Not a binary layout";
+        return false;
+    }
+
+    if (formatVersion > KDDOCKWIDGETS_BINARY_FORMAT_VERSION) {
+        qWarning() << Q_FUNC_INFO << "Unsupported binary format version. Got=" << formatVersion
+                   << "; expected equal or less than" << KDDOCKWIDGETS_BINARY_FORMAT_VERSION;
+        return false;
+    }
+
+    fromDataStream(ds);
+    if (ds.status() != QDataStream::Ok) {
+        qWarning() << Q_FUNC_INFO << "Corrupt binary layout";
+        return false;
+    }
+
+    if (serializationVersion > KDDOCKWIDGETS_SERIALIZATION_VERSION) {
+        qWarning() << "Unsupported serialization version. Got=" << serializationVersion
+                   << "; expected equal or less than" << KDDOCKWIDGETS_SERIALIZATION_VERSION;
+        return false;
+    }
+
+    return true;
+}
+
+bool LayoutSaver::Layout::isBinary(const QByteArray &data)
+{
+    QDataStream ds(data);
+    quint32 magic = 0;
+    ds >> magic;
+    return ds.status() == QDataStream::Ok && magic == KDDOCKWIDGETS_BINARY_MAGIC;
+}
+
 QVariantMap LayoutSaver::Layout::toVariantMap() const
 {
     QVariantMap map;
@@ -486,6 +786,46 @@ void LayoutSaver::Layout::fromVariantMap(const QVariantMap &map)
     screenInfo = fromVariantList<LayoutSaver::ScreenInfo>(map.value(QStringLiteral("screenInfo")).toList());
 }
 
+void LayoutSaver::Layout::toDataStream(QDataStream &ds) const
+{
+    ds << qint32(serializationVersion);
+
+    // Dock widgets first, the other structs only reference them by name
+    ds << qint32(allDockWidgets.size());
+    for (const auto &dw : allDockWidgets) {
+        ds << dw->uniqueName;
+        dw->toDataStream(ds);
+    }
+
+    writeDockWidgetNames(ds, closedDockWidgets);
+    writeList(ds, mainWindows);
+    writeList(ds, floatingWindows);
+    writeList(ds, screenInfo);
+}
+
+void LayoutSaver::Layout::fromDataStream(QDataStream &ds)
+{
+    qint32 version = 0;
+    ds >> version;
+    serializationVersion = version;
+
+    qint32 numDockWidgets = 0;
+    ds >> numDockWidgets;
+    allDockWidgets.clear();
+    for (int i = 0; i < numDockWidgets && ds.status() == QDataStream::Ok; ++i) {
+        QString name;
+        ds >> name;
+        auto dw = LayoutSaver::DockWidget::dockWidgetForName(name);
+        dw->fromDataStream(ds);
+        allDockWidgets.push_back(dw);
+    }
+
+    readDockWidgetNames(ds, closedDockWidgets);
+    readList(ds, mainWindows);
+    readList(ds, floatingWindows);
+    readList(ds, screenInfo);
+}
+
 void LayoutSaver::Layout::scaleSizes()
 {
     if (mainWindows.isEmpty())
@@ -575,6 +915,37 @@ void LayoutSaver::Item::fromVariantMap(const QVariantMap &map)
     frame.fromVariantMap(map.value(QStringLiteral("frame"), QVariantMap()).toMap());
 }
 
+void LayoutSaver::Item::toDataStream(QDataStream &ds) const
+{
+    ds << objectName << isPlaceholder << geometry << minSize;
+    ds << qint32(indexOfLeftAnchor) << qint32(indexOfTopAnchor)
+       << qint32(indexOfRightAnchor) << qint32(indexOfBottomAnchor);
+
+    ds << !frame.isNull;
+    if (!frame.isNull)
+        frame.toDataStream(ds);
+}
+
+void LayoutSaver::Item::fromDataStream(QDataStream &ds)
+{
+    qint32 left = 0, top = 0, right = 0, bottom = 0;
+    ds >> objectName >> isPlaceholder >> geometry >> minSize;
+    ds >> left >> top >> right >> bottom;
+    indexOfLeftAnchor = left;
+    indexOfTopAnchor = top;
+    indexOfRightAnchor = right;
+    indexOfBottomAnchor = bottom;
+
+    bool hasFrame = false;
+    ds >> hasFrame;
+    if (hasFrame) {
+        frame.fromDataStream(ds);
+    } else {
+        frame.isNull = true;
+        frame.dockWidgets.clear();
+    }
+}
+
 bool LayoutSaver::Frame::isValid() const
 {
     if (!isNull)
@@ -646,6 +1017,30 @@ void LayoutSaver::Frame::fromVariantMap(const QVariantMap &map)
     }
 }
 
+void LayoutSaver::Frame::toDataStream(QDataStream &ds) const
+{
+    // isNull is written by Item::toDataStream(), null frames aren't streamed at all
+    ds << objectName << geometry << quint32(options) << qint32(currentTabIndex);
+    writeDockWidgetNames(ds, dockWidgets);
+}
+
+void LayoutSaver::Frame::fromDataStream(QDataStream &ds)
+{
+    quint32 opts = 0;
+    qint32 tabIndex = 0;
+    ds >> objectName >> geometry >> opts >> tabIndex;
+    isNull = false;
+    options = opts;
+    currentTabIndex = tabIndex;
+    readDockWidgetNames(ds, dockWidgets);
+}
+
+QHash<QString, LayoutSaver::DockWidget::Ptr> &LayoutSaver::DockWidget::dockWidgets()
+{
+    static thread_local QHash<QString, Ptr> s_dockWidgets;
+    return s_dockWidgets;
+}
+
 bool LayoutSaver::DockWidget::isValid() const
 {
     return !uniqueName.isEmpty();
@@ -674,6 +1069,19 @@ void LayoutSaver::DockWidget::fromVariantMap(const QVariantMap &map)
     lastPosition.fromVariantMap(map.value(QStringLiteral("lastPosition")).toMap());
 }
 
+void LayoutSaver::DockWidget::toDataStream(QDataStream &ds) const
+{
+    // uniqueName is written by Layout::toDataStream(), as it needs it to find the shared instance
+    ds << affinityName;
+    lastPosition.toDataStream(ds);
+}
+
+void LayoutSaver::DockWidget::fromDataStream(QDataStream &ds)
+{
+    ds >> affinityName;
+    lastPosition.fromDataStream(ds);
+}
+
 bool LayoutSaver::Anchor::isValid(const LayoutSaver::MultiSplitterLayout &layout) const
 {
     const bool isStatic = type != KDDockWidgets::Anchor::Type_None;
@@ -772,6 +1180,25 @@ void LayoutSaver::Anchor::fromVariantMap(const QVariantMap &map)
         side2Items.push_back(v.toInt());
 }
 
+void LayoutSaver::Anchor::toDataStream(QDataStream &ds) const
+{
+    ds << objectName << geometry << qint32(orientation) << qint32(type)
+       << qint32(indexOfFrom) << qint32(indexOfTo) << qint32(indexOfFollowee)
+       << positionPercentage << side1Items << side2Items;
+}
+
+void LayoutSaver::Anchor::fromDataStream(QDataStream &ds)
+{
+    qint32 o = 0, t = 0, from = 0, to = 0, followee = 0;
+    ds >> objectName >> geometry >> o >> t >> from >> to >> followee
+       >> positionPercentage >> side1Items >> side2Items;
+    orientation = o;
+    type = t;
+    indexOfFrom = from;
+    indexOfTo = to;
+    indexOfFollowee = followee;
+}
+
 void LayoutSaver::Anchor::scaleSizes(const ScalingInfo &scalingInfo)
 {
     const QPoint pos = geometry.topLeft();
@@ -834,6 +1261,22 @@ void LayoutSaver::FloatingWindow::fromVariantMap(const QVariantMap &map)
     affinityName = map.value(QStringLiteral("affinityName")).toString();
 }
 
+void LayoutSaver::FloatingWindow::toDataStream(QDataStream &ds) const
+{
+    multiSplitterLayout.toDataStream(ds);
+    ds << qint32(parentIndex) << geometry << qint32(screenIndex) << screenSize
+       << isVisible << affinityName;
+}
+
+void LayoutSaver::FloatingWindow::fromDataStream(QDataStream &ds)
+{
+    qint32 parent = -1, screen = 0;
+    multiSplitterLayout.fromDataStream(ds);
+    ds >> parent >> geometry >> screen >> screenSize >> isVisible >> affinityName;
+    parentIndex = parent;
+    screenIndex = screen;
+}
+
 bool LayoutSaver::MainWindow::isValid() const
 {
     if (!multiSplitterLayout.isValid())
@@ -891,6 +1334,23 @@ void LayoutSaver::MainWindow::fromVariantMap(const QVariantMap &map)
     isVisible = map.value(QStringLiteral("isVisible")).toBool();
 }
 
+void LayoutSaver::MainWindow::toDataStream(QDataStream &ds) const
+{
+    ds << qint32(options);
+    multiSplitterLayout.toDataStream(ds);
+    ds << uniqueName << affinityName << geometry << qint32(screenIndex) << screenSize << isVisible;
+}
+
+void LayoutSaver::MainWindow::fromDataStream(QDataStream &ds)
+{
+    qint32 opts = 0, screen = 0;
+    ds >> opts;
+    options = KDDockWidgets::MainWindowOptions(opts);
+    multiSplitterLayout.fromDataStream(ds);
+    ds >> uniqueName >> affinityName >> geometry >> screen >> screenSize >> isVisible;
+    screenIndex = screen;
+}
+
 bool LayoutSaver::MultiSplitterLayout::isValid() const
 {
     for (auto &item : items) {
@@ -913,6 +1373,7 @@ bool LayoutSaver::MultiSplitterLayout::isValid() const
 
 void LayoutSaver::MultiSplitterLayout::scaleSizes(const ScalingInfo &scalingInfo)
 {
+    encodingCache.reset();
     scalingInfo.applyFactorsTo(/*by-ref*/size);
     for (LayoutSaver::Anchor &anchor : anchors)
         anchor.scaleSizes(scalingInfo);
@@ -922,6 +1383,9 @@ void LayoutSaver::MultiSplitterLayout::scaleSizes(const ScalingInfo &scalingInfo
 
 QVariantMap LayoutSaver::MultiSplitterLayout::toVariantMap() const
 {
+    if (encodingCache && !encodingCache->variantMap.isEmpty())
+        return encodingCache->variantMap;
+
     QVariantMap map;
 
     map.insert(QStringLiteral("anchors"), toVariantList<LayoutSaver::Anchor>(anchors));
@@ -929,17 +1393,55 @@ QVariantMap LayoutSaver::MultiSplitterLayout::toVariantMap() const
     map.insert(QStringLiteral("minSize"), sizeToMap(minSize));
     map.insert(QStringLiteral("size"), sizeToMap(size));
 
+    if (encodingCache)
+        encodingCache->variantMap = map;
+
     return map;
 }
 
 void LayoutSaver::MultiSplitterLayout::fromVariantMap(const QVariantMap &map)
 {
+    encodingCache.reset();
     anchors = fromVariantList<LayoutSaver::Anchor>(map.value(QStringLiteral("anchors")).toList());
     items = fromVariantList<LayoutSaver::Item>(map.value(QStringLiteral("items")).toList());
     minSize = mapToSize(map.value(QStringLiteral("minSize")).toMap());
     size = mapToSize(map.value(QStringLiteral("size")).toMap());
 }
 
+void LayoutSaver::MultiSplitterLayout::toDataStream(QDataStream &ds) const
+{
+    if (!encodingCache) {
+        writeList(ds, anchors);
+        writeList(ds, items);
+        ds << minSize << size;
+        return;
+    }
+
+    if (encodingCache->binaryVersion != ds.version()) {
+        // Encode into a buffer once, then just copy the bytes on the following saves
+        QByteArray &binary = encodingCache->binary;
+        binary.clear();
+        QDataStream fragment(&binary, QIODevice::WriteOnly);
+        fragment.setVersion(ds.version());
+        fragment.setByteOrder(ds.byteOrder());
+        fragment.setFloatingPointPrecision(ds.floatingPointPrecision());
+        writeList(fragment, anchors);
+        writeList(fragment, items);
+        fragment << minSize << size;
+        encodingCache->binaryVersion = ds.version();
+    }
+
+    ds.writeRawData(encodingCache->binary.constData(), encodingCache->binary.size());
+}
+
+void LayoutSaver::MultiSplitterLayout::fromDataStream(QDataStream &ds)
+{
+    encodingCache.reset();
+    readList(ds, anchors);
+    readList(ds, items);
+    ds >> minSize >> size;
+}
+
 void LayoutSaver::LastPosition::scaleSizes(const ScalingInfo &scalingInfo)
 {
     scalingInfo.applyFactorsTo(/*by-ref*/lastFloatingGeometry);
@@ -964,6 +1466,20 @@ void LayoutSaver::LastPosition::fromVariantMap(const QVariantMap &map)
     placeholders = fromVariantList<LayoutSaver::Placeholder>(map.value(QStringLiteral("placeholders")).toList());
 }
 
+void LayoutSaver::LastPosition::toDataStream(QDataStream &ds) const
+{
+    ds << lastFloatingGeometry << qint32(tabIndex) << wasFloating;
+    writeList(ds, placeholders);
+}
+
+void LayoutSaver::LastPosition::fromDataStream(QDataStream &ds)
+{
+    qint32 index = 0;
+    ds >> lastFloatingGeometry >> index >> wasFloating;
+    tabIndex = index;
+    readList(ds, placeholders);
+}
+
 QVariantMap LayoutSaver::ScreenInfo::toVariantMap() const
 {
     QVariantMap map;
@@ -983,6 +1499,18 @@ void LayoutSaver::ScreenInfo::fromVariantMap(const QVariantMap &map)
     devicePixelRatio = map.value(QStringLiteral("devicePixelRatio")).toDouble();
 }
 
+void LayoutSaver::ScreenInfo::toDataStream(QDataStream &ds) const
+{
+    ds << qint32(index) << geometry << name << devicePixelRatio;
+}
+
+void LayoutSaver::ScreenInfo::fromDataStream(QDataStream &ds)
+{
+    qint32 i = 0;
+    ds >> i >> geometry >> name >> devicePixelRatio;
+    index = i;
+}
+
 QVariantMap LayoutSaver::Placeholder::toVariantMap() const
 {
     QVariantMap map;
@@ -1005,6 +1533,33 @@ void LayoutSaver::Placeholder::fromVariantMap(const QVariantMap &map)
     mainWindowUniqueName = map.value(QStringLiteral("mainWindowUniqueName")).toString();
 }
 
+void LayoutSaver::Placeholder::toDataStream(QDataStream &ds) const
+{
+    ds << isFloatingWindow << qint32(itemIndex);
+
+    if (isFloatingWindow)
+        ds << qint32(indexOfFloatingWindow);
+    else
+        ds << mainWindowUniqueName;
+}
+
+void LayoutSaver::Placeholder::fromDataStream(QDataStream &ds)
+{
+    qint32 index = 0;
+    ds >> isFloatingWindow >> index;
+    itemIndex = index;
+
+    // Same defaults as fromVariantMap(), for the fields that aren't saved
+    indexOfFloatingWindow = -1;
+    mainWindowUniqueName.clear();
+    if (isFloatingWindow) {
+        ds >> index;
+        indexOfFloatingWindow = index;
+    } else {
+        ds >> mainWindowUniqueName;
+    }
+}
+
 LayoutSaver::ScalingInfo::ScalingInfo(const QString &mainWindowId, QRect savedMainWindowGeo)
 {
     auto mainWindow = DockRegistry::self()->mainWindowByName(mainWindowId);
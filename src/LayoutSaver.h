@@ -32,8 +32,12 @@
 
 #include "KDDockWidgets.h"
 
+#include <functional>
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 class QByteArray;
+class QObject;
 QT_END_NAMESPACE
 
 namespace KDDockWidgets {
@@ -43,6 +47,25 @@ class DockWidgetBase;
 class DOCKS_EXPORT LayoutSaver
 {
 public:
+    struct Layout;
+    struct MainWindow;
+    struct FloatingWindow;
+    struct DockWidget;
+    struct LastPosition;
+    struct MultiSplitterLayout;
+    struct Item;
+    struct Anchor;
+    struct Frame;
+    struct Placeholder;
+    struct ScalingInfo;
+    struct ScreenInfo;
+
+    ///@brief The formats a layout can be saved in. restoreLayout() detects the format by itself.
+    enum Format {
+        Format_Json = 0, ///< Human readable JSON. The default.
+        Format_Binary ///< Compact versioned binary format. Faster to save and restore, for example for auto-saving.
+    };
+
     ///@brief Constructor. Construction on the stack is suggested.
     explicit LayoutSaver(RestoreOptions options = RestoreOption_None);
 
@@ -55,9 +78,10 @@ public:
     /**
      * @brief saves the layout to JSON file
      * @brief jsonFilename the filename where the layout will be saved to
+     * @param format the format to save in, JSON by default
      * @return true on success
      */
-    bool saveToFile(const QString &jsonFilename);
+    bool saveToFile(const QString &jsonFilename, Format format = Format_Json);
 
     /**
      * @brief restores the layout from a JSON file
@@ -68,11 +92,13 @@ public:
 
     /**
      * @brief saves the layout into a byte array
+     * @param format the format to save in, JSON by default
      */
-    QByteArray serializeLayout() const;
+    QByteArray serializeLayout(Format format = Format_Json) const;
 
     /**
      * @brief restores the layout from a byte array
+     * The data can be in any of the formats supported by serializeLayout().
      * All MainWindows and DockWidgets should have been created before calling
      * this function.
      *
@@ -85,6 +111,40 @@ public:
      */
     bool restoreLayout(const QByteArray &);
 
+    /**
+     * @brief restores the layout from a file, reading and parsing it in a worker thread
+     *
+     * Only the final step, which creates and moves the windows, runs in the GUI thread, once the
+     * file has been parsed and validated. This LayoutSaver doesn't need to outlive the call, the
+     * restore options and affinity names are copied.
+     *
+     * @param filename the file containing a saved layout
+     * @param context must not be null. The restore is cancelled if this object is destroyed before parsing finishes
+     * @param callback optional, called in the GUI thread with the result of the restore
+     */
+    void restoreFromFileAsync(const QString &filename, QObject *context,
+                              const std::function<void(bool)> &callback = {});
+
+    /**
+     * @brief parses and validates a saved layout without restoring it
+     *
+     * Unlike the rest of LayoutSaver, this function doesn't touch any window and can be called
+     * from any thread. Pass the result to restoreParsedLayout() in the GUI thread.
+     *
+     * @return the parsed layout, or nullptr if @p data isn't a valid layout
+     */
+    static std::shared_ptr<Layout> parseLayout(const QByteArray &data);
+
+    ///@brief Like parseLayout(), but reads the layout from @p filename. Can also be called from any thread.
+    static std::shared_ptr<Layout> parseLayoutFile(const QString &filename);
+
+    /**
+     * @brief restores a layout previously returned by parseLayout() or parseLayoutFile()
+     * A parsed layout can only be restored once, as restoring might scale its sizes in place.
+     * @return true on success
+     */
+    bool restoreParsedLayout(const std::shared_ptr<Layout> &layout);
+
     /**
      * @brief returns a list of dock widgets which were restored since the last
      * @ref restoreLayout() or @ref restoreFromDisk()
@@ -102,19 +162,6 @@ public:
      */
     void setAffinityNames(const QStringList &affinityNames);
 
-    struct Layout;
-    struct MainWindow;
-    struct FloatingWindow;
-    struct DockWidget;
-    struct LastPosition;
-    struct MultiSplitterLayout;
-    struct Item;
-    struct Anchor;
-    struct Frame;
-    struct Placeholder;
-    struct ScalingInfo;
-    struct ScreenInfo;
-
 private:
     friend class TestDocks;
 
@@ -28,6 +28,7 @@
 #include <QDataStream>
 #include <QDebug>
 #include <QScreen>
+#include <QThread>
 #include <QApplication>
 #include <QJsonDocument>
 
@@ -43,6 +44,14 @@
   */
 #define KDDOCKWIDGETS_SERIALIZATION_VERSION 2
 
+/**
+  * Magic and version of the binary format, see LayoutSaver::Format_Binary.
+  * Bump the version whenever the binary format changes.
+  * version 1: Initial version
+  */
+#define KDDOCKWIDGETS_BINARY_MAGIC 0x4b444457 // "KDDW"
+#define KDDOCKWIDGETS_BINARY_FORMAT_VERSION 1
+
 
 namespace KDDockWidgets {
 
@@ -78,6 +87,8 @@ struct LayoutSaver::Placeholder
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     bool isFloatingWindow;
     int indexOfFloatingWindow;
@@ -120,6 +131,8 @@ struct LayoutSaver::LastPosition
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 };
 
 struct DOCKS_EXPORT LayoutSaver::DockWidget
@@ -127,7 +140,9 @@ struct DOCKS_EXPORT LayoutSaver::DockWidget
     // Using shared ptr, as we need to modify shared instances
     typedef std::shared_ptr<LayoutSaver::DockWidget> Ptr;
     typedef QVector<Ptr> List;
-    static QHash<QString, Ptr> s_dockWidgets;
+
+    ///@brief The instances created so far, by name. Per thread, as layouts can be parsed in a worker thread.
+    static QHash<QString, Ptr> &dockWidgets();
 
     bool isValid() const;
 
@@ -136,12 +151,13 @@ struct DOCKS_EXPORT LayoutSaver::DockWidget
 
     static Ptr dockWidgetForName(const QString &name)
     {
-        auto dw = s_dockWidgets.value(name);
+        QHash<QString, Ptr> &instances = dockWidgets();
+        auto dw = instances.value(name);
         if (dw)
             return dw;
 
         dw = Ptr(new LayoutSaver::DockWidget);
-        s_dockWidgets.insert(name, dw);
+        instances.insert(name, dw);
         dw->uniqueName = name;
 
         return dw;
@@ -149,6 +165,8 @@ struct DOCKS_EXPORT LayoutSaver::DockWidget
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     QString uniqueName;
     QString affinityName;
@@ -188,6 +206,8 @@ struct LayoutSaver::Frame
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     bool isNull = true;
     QString objectName;
@@ -208,6 +228,8 @@ struct LayoutSaver::Item
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     QString objectName;
     bool isPlaceholder;
@@ -228,6 +250,8 @@ struct LayoutSaver::Anchor
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
     void scaleSizes(const ScalingInfo &);
 
     bool isVertical() const;
@@ -246,17 +270,30 @@ struct LayoutSaver::Anchor
 
 struct LayoutSaver::MultiSplitterLayout
 {
+    /// The encoded forms of an unchanged layout, so saving it again doesn't re-encode it
+    struct EncodingCache {
+        QVariantMap variantMap; // for JSON
+        QByteArray binary;
+        int binaryVersion = -1; // the QDataStream version binary was encoded with
+    };
+
     bool isValid() const;
     /// Iterates throught the layout and patches all absolute sizes. See RestoreOption_RelativeToMainWindow.
     void scaleSizes(const ScalingInfo &scalingInfo);
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     LayoutSaver::Anchor::List anchors;
     LayoutSaver::Item::List items;
     QSize minSize;
     QSize size;
+
+    /// Only set by ::MultiSplitterLayout::serialize(). Shared between copies of the same snapshot,
+    /// so it must be reset by anything modifying the members above.
+    std::shared_ptr<EncodingCache> encodingCache;
 };
 
 struct LayoutSaver::FloatingWindow
@@ -270,6 +307,8 @@ struct LayoutSaver::FloatingWindow
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     LayoutSaver::MultiSplitterLayout multiSplitterLayout;
     QString affinityName;
@@ -292,6 +331,8 @@ public:
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     KDDockWidgets::MainWindowOptions options;
     LayoutSaver::MultiSplitterLayout multiSplitterLayout;
@@ -313,6 +354,8 @@ struct LayoutSaver::ScreenInfo
 
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     int index;
     QRect geometry;
@@ -327,6 +370,11 @@ public:
     Layout() {
         s_currentLayoutBeingRestored = this;
 
+        // The screen info is only needed when saving. Layouts can be parsed in a worker thread,
+        // where QScreen can't be used, and parsing overwrites it anyway.
+        if (QThread::currentThread() != qApp->thread())
+            return;
+
         const QList<QScreen*> screens = qApp->screens();
         for (int i = 0; i < screens.size(); ++i) {
             ScreenInfo info;
@@ -347,14 +395,21 @@ public:
     bool fillFrom(const QByteArray &serialized);
     QByteArray toJson() const;
     bool fromJson(const QByteArray &jsonData);
+    QByteArray toBinary() const;
+    bool fromBinary(const QByteArray &data);
+
+    ///@brief returns whether @p data was produced by toBinary(), as opposed to toJson()
+    static bool isBinary(const QByteArray &data);
     QVariantMap toVariantMap() const;
     void fromVariantMap(const QVariantMap &map);
+    void toDataStream(QDataStream &) const;
+    void fromDataStream(QDataStream &);
 
     /// Iterates throught the layout and patches all absolute sizes. See RestoreOption_RelativeToMainWindow.
     void scaleSizes();
 
     friend QDataStream &operator>>(QDataStream &ds, LayoutSaver::Frame *frame);
-    static LayoutSaver::Layout* s_currentLayoutBeingRestored;
+    static thread_local LayoutSaver::Layout* s_currentLayoutBeingRestored;
 
     LayoutSaver::MainWindow mainWindowForIndex(int index) const;
 
@@ -544,7 +599,7 @@ inline QDataStream &operator>>(QDataStream &ds, LayoutSaver::MainWindow *m)
 
 inline QDataStream &operator>>(QDataStream &ds, LayoutSaver::Layout *l)
 {
-    LayoutSaver::DockWidget::s_dockWidgets.clear();
+    LayoutSaver::DockWidget::dockWidgets().clear();
     int numMainWindows;
     int numFloatingWindows;
     int numClosedDockWidgets;
@@ -93,6 +93,15 @@ void MainWindowBase::addDockWidget(DockWidgetBase *dw, Location location, DockWi
     dropArea()->addDockWidget(dw, location, relativeTo, option);
 }
 
+void MainWindowBase::addDockWidgets(const QVector<DockWidgetInsertion> &insertions)
+{
+    MultiSplitterLayout *layout = multiSplitterLayout();
+    layout->beginAddingBatch();
+    for (const DockWidgetInsertion &insertion : insertions)
+        addDockWidget(insertion.dockWidget, insertion.location, insertion.relativeTo, insertion.option);
+    layout->endAddingBatch();
+}
+
 QString MainWindowBase::uniqueName() const
 {
     return d->name;
@@ -56,6 +56,18 @@ class DOCKS_EXPORT MainWindowBase : public QMainWindowOrQuick
     Q_OBJECT
 public:
     typedef QVector<MainWindowBase*> List;
+
+    /**
+     * @brief One dock widget to add with addDockWidgets(). The arguments of addDockWidget().
+     * Trailing members can be omitted, for example { dockWidget, Location_OnLeft }.
+     */
+    struct DockWidgetInsertion {
+        DockWidgetBase *dockWidget;
+        KDDockWidgets::Location location;
+        DockWidgetBase *relativeTo = nullptr;
+        AddingOption option = {};
+    };
+
     explicit MainWindowBase(const QString &uniqueName, MainWindowOptions options = MainWindowOption_HasCentralFrame,
                             QWidgetOrQuick *parent = nullptr, Qt::WindowFlags flags = {});
 
@@ -81,6 +93,16 @@ public:
                        KDDockWidgets::Location location,
                        DockWidgetBase *relativeTo = nullptr, AddingOption option = {});
 
+    /**
+     * @brief Docks several dock widgets into this main window, in order.
+     *
+     * Equivalent to calling addDockWidget() for each entry, and results in the same layout, but the
+     * frames are only resized once, at the end. Prefer it when building a layout with many dock widgets.
+     * An entry can be relative to a dock widget added by a previous entry.
+     * @param insertions The dock widgets to add, with the same arguments as addDockWidget()
+     */
+    void addDockWidgets(const QVector<DockWidgetInsertion> &insertions);
+
     /**
      * @brief Returns the unique name that was passed via constructor.
      *        Used internally by the save/restore mechanism.
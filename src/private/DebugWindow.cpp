@@ -278,6 +278,24 @@ DebugWindow::DebugWindow(QWidget *parent)
             l->updateAnchorFollowing();
     });
 
+    button = new QPushButton(this);
+    button->setText(QStringLiteral("Dump layout stats"));
+    layout->addWidget(button);
+    connect(button, &QPushButton::clicked, this, [] {
+        const auto layouts = DockRegistry::self()->layouts();
+        for (auto l : layouts)
+            qDebug().noquote() << l->multiSplitter()->window() << "\n" << l->stats().toString();
+    });
+
+    button = new QPushButton(this);
+    button->setText(QStringLiteral("Reset layout stats"));
+    layout->addWidget(button);
+    connect(button, &QPushButton::clicked, this, [] {
+        const auto layouts = DockRegistry::self()->layouts();
+        for (auto l : layouts)
+            l->resetStats();
+    });
+
     button = new QPushButton(this);
     button->setText(QStringLiteral("Raise #0 (after 3s timeout)"));
     layout->addWidget(button);
@@ -97,14 +97,56 @@ void DockRegistry::registerDockWidget(DockWidgetBase *dock)
     }
 
     m_dockWidgets << dock;
+
+    // On duplicates the first one registered wins, as dockByName() always did
+    if (!m_dockWidgetsByName.contains(dock->uniqueName()))
+        m_dockWidgetsByName.insert(dock->uniqueName(), dock);
+
+    if (QWidget *guest = dock->widget())
+        onDockWidgetGuestChanged(dock, guest);
+
+    connect(dock, &DockWidgetBase::widgetChanged, this, [this, dock] (QWidget *guest) {
+        onDockWidgetGuestChanged(dock, guest);
+    });
 }
 
 void DockRegistry::unregisterDockWidget(DockWidgetBase *dock)
 {
+    disconnect(dock, &DockWidgetBase::widgetChanged, this, nullptr);
     m_dockWidgets.removeOne(dock);
+
+    const QString name = dock->uniqueName();
+    if (m_dockWidgetsByName.value(name) == dock) {
+        m_dockWidgetsByName.remove(name);
+        // If there was a duplicate then it takes over the name
+        for (DockWidgetBase *other : qAsConst(m_dockWidgets)) {
+            if (other->uniqueName() == name) {
+                m_dockWidgetsByName.insert(name, other);
+                break;
+            }
+        }
+    }
+
+    removeGuestIndex(dock);
     maybeDelete();
 }
 
+void DockRegistry::onDockWidgetGuestChanged(DockWidgetBase *dock, QWidget *guest)
+{
+    removeGuestIndex(dock);
+    if (guest) {
+        m_dockWidgetsByGuest.insert(guest, dock);
+        m_guestsByDockWidget.insert(dock, guest);
+    }
+}
+
+void DockRegistry::removeGuestIndex(DockWidgetBase *dock)
+{
+    QWidget *guest = m_guestsByDockWidget.take(dock);
+    if (guest && m_dockWidgetsByGuest.value(guest) == dock)
+        m_dockWidgetsByGuest.remove(guest);
+}
+
 void DockRegistry::registerMainWindow(MainWindowBase *mainWindow)
 {
     if (mainWindow->uniqueName().isEmpty()) {
@@ -114,11 +156,26 @@ void DockRegistry::registerMainWindow(MainWindowBase *mainWindow)
     }
 
     m_mainWindows << mainWindow;
+
+    if (!m_mainWindowsByName.contains(mainWindow->uniqueName()))
+        m_mainWindowsByName.insert(mainWindow->uniqueName(), mainWindow);
 }
 
 void DockRegistry::unregisterMainWindow(MainWindowBase *mainWindow)
 {
     m_mainWindows.removeOne(mainWindow);
+
+    const QString name = mainWindow->uniqueName();
+    if (m_mainWindowsByName.value(name) == mainWindow) {
+        m_mainWindowsByName.remove(name);
+        for (MainWindowBase *other : qAsConst(m_mainWindows)) {
+            if (other->uniqueName() == name) {
+                m_mainWindowsByName.insert(name, other);
+                break;
+            }
+        }
+    }
+
     maybeDelete();
 }
 
@@ -155,22 +212,12 @@ void DockRegistry::unregisterFrame(Frame *frame)
 
 DockWidgetBase *DockRegistry::dockByName(const QString &name) const
 {
-    for (auto dock : qAsConst(m_dockWidgets)) {
-        if (dock->uniqueName() == name)
-            return dock;
-    }
-
-    return nullptr;
+    return m_dockWidgetsByName.value(name);
 }
 
 MainWindowBase *DockRegistry::mainWindowByName(const QString &name) const
 {
-    for (auto mainWindow : qAsConst(m_mainWindows)) {
-        if (mainWindow->uniqueName() == name)
-            return mainWindow;
-    }
-
-    return nullptr;
+    return m_mainWindowsByName.value(name);
 }
 
 DockWidgetBase *DockRegistry::dockWidgetForGuest(QWidget *guest) const
@@ -178,12 +225,19 @@ DockWidgetBase *DockRegistry::dockWidgetForGuest(QWidget *guest) const
     if (!guest)
         return nullptr;
 
-    for (DockWidgetBase *dw : m_dockWidgets) {
-        if (dw->widget() == guest)
-            return dw;
-    }
+    // The guest might have been deleted and its address reused, so double-check
+    DockWidgetBase *dw = m_dockWidgetsByGuest.value(guest);
+    return dw && dw->widget() == guest ? dw : nullptr;
+}
 
-    return nullptr;
+int DockRegistry::dockWidgetCount() const
+{
+    return m_dockWidgets.size();
+}
+
+int DockRegistry::mainWindowCount() const
+{
+    return m_mainWindows.size();
 }
 
 bool DockRegistry::isSane() const
@@ -334,6 +388,107 @@ void DockRegistry::clear(QStringList affinities, bool deleteStaticAnchors)
     }
 }
 
+void DockRegistry::clear(QStringList affinities, const MainWindowBase::List &mainWindowsToKeep,
+                         const Frame::List &framesToKeep, bool deleteStaticAnchors)
+{
+    if (mainWindowsToKeep.isEmpty() && framesToKeep.isEmpty()) {
+        clear(affinities, deleteStaticAnchors);
+        return;
+    }
+
+    if (!affinities.isEmpty()) {
+        // empty affinity also matches and will be closed
+        affinities << QString();
+    }
+
+    auto matchesAffinity = [&affinities] (const QString &affinityName) {
+        return affinities.isEmpty() || affinities.contains(affinityName);
+    };
+
+    MainWindowBase::List mainWindowsToClear;
+    for (auto mw : qAsConst(m_mainWindows)) {
+        if (matchesAffinity(mw->affinityName()) && !mainWindowsToKeep.contains(mw))
+            mainWindowsToClear.push_back(mw);
+    }
+
+    // Detach the frames to keep, otherwise clearing their main window's layout, or closing their
+    // floating window, would delete them
+    for (Frame *frame : framesToKeep) {
+        Item *item = frame->layoutItem();
+        MultiSplitterLayout *layout = item ? item->layout() : nullptr;
+        if (!layout)
+            continue;
+
+        FloatingWindow *fw = frame->floatingWindow();
+        bool detach = fw && matchesAffinity(fw->affinityName());
+        for (MainWindowBase *mw : qAsConst(mainWindowsToClear))
+            detach = detach || mw->multiSplitterLayout() == layout;
+
+        if (detach) {
+            frame->setParent(nullptr);
+            m_framesToReuse.push_back(frame);
+        }
+    }
+
+    auto isKept = [this, &mainWindowsToKeep] (DockWidgetBase *dw) {
+        Frame *frame = dw->frame();
+        if (!frame)
+            return false;
+
+        if (m_framesToReuse.contains(frame))
+            return true;
+
+        Item *item = frame->layoutItem();
+        MultiSplitterLayout *layout = item ? item->layout() : nullptr;
+        if (!layout)
+            return false;
+
+        for (MainWindowBase *mw : mainWindowsToKeep) {
+            if (mw->multiSplitterLayout() == layout)
+                return true;
+        }
+        return false;
+    };
+
+    for (auto dw : qAsConst(m_dockWidgets)) {
+        if (matchesAffinity(dw->affinityName())) {
+            if (!isKept(dw))
+                dw->forceClose();
+            dw->lastPosition()->removePlaceholders();
+        }
+    }
+
+    for (auto mw : qAsConst(mainWindowsToClear))
+        mw->multiSplitterLayout()->clear(deleteStaticAnchors);
+}
+
+Frame *DockRegistry::takeFrameToReuse(const LayoutSaver::Frame &saved)
+{
+    for (int i = 0; i < m_framesToReuse.size(); ++i) {
+        Frame *frame = m_framesToReuse.at(i);
+        if (frame && frame->hasSameDockWidgets(saved)) {
+            m_framesToReuse.removeAt(i);
+            return frame;
+        }
+    }
+
+    return nullptr;
+}
+
+void DockRegistry::releaseFramesToReuse()
+{
+    const auto frames = m_framesToReuse;
+    m_framesToReuse.clear();
+    for (const QPointer<Frame> &frame : frames) {
+        if (!frame)
+            continue;
+
+        const DockWidgetBase::List docks = frame->dockWidgets();
+        for (DockWidgetBase *dw : docks)
+            dw->forceClose();
+    }
+}
+
 void DockRegistry::ensureAllFloatingWidgetsAreMorphed()
 {
     for (DockWidgetBase *dw : qAsConst(m_dockWidgets)) {
@@ -25,8 +25,10 @@
 #include "MainWindowBase.h"
 #include "FloatingWindow_p.h"
 
+#include <QHash>
 #include <QVector>
 #include <QObject>
+#include <QPointer>
 
 /**
  * DockRegistry is a singleton that knows about all DockWidgets.
@@ -63,6 +65,12 @@ public:
     /// @brief returns the dock widget that hosts @p guest widget. Nullptr if there's none.
     DockWidgetBase *dockWidgetForGuest(QWidget *guest) const;
 
+    ///@brief returns the number of DockWidget instances. Cheaper than dockwidgets().size()
+    int dockWidgetCount() const;
+
+    ///@brief returns the number of MainWindow instances
+    int mainWindowCount() const;
+
     bool isSane() const;
 
     ///@brief returns all DockWidget instances
@@ -109,6 +117,22 @@ public:
      */
     void clear(QStringList affinities, bool deleteStaticAnchors = false);
 
+    /**
+     * @brief Overload that leaves the layouts of @p mainWindowsToKeep untouched, and detaches
+     * @p framesToKeep from the layouts being cleared instead of deleting them.
+     * The dock widgets docked in them aren't closed, only their placeholder info is cleared.
+     * The detached frames are handed out again by takeFrameToReuse().
+     * Used by RestoreOption_Incremental.
+     */
+    void clear(QStringList affinities, const MainWindowBase::List &mainWindowsToKeep,
+               const Frame::List &framesToKeep, bool deleteStaticAnchors);
+
+    ///@brief Returns a frame detached by clear() which shows the same dock widgets as @p saved, or nullptr
+    Frame *takeFrameToReuse(const LayoutSaver::Frame &saved);
+
+    ///@brief Closes the dock widgets of the detached frames nobody took, which deletes the frames
+    void releaseFramesToReuse();
+
     /**
      * @brief Ensures that all floating DockWidgets have a FloatingWindow as a window.
      *
@@ -142,10 +166,17 @@ protected:
 private:
     explicit DockRegistry(QObject *parent = nullptr);
     void maybeDelete();
+    void onDockWidgetGuestChanged(DockWidgetBase *, QWidget *guest);
+    void removeGuestIndex(DockWidgetBase *);
     bool m_isProcessingAppQuitEvent = false;
     DockWidgetBase::List m_dockWidgets;
     MainWindowBase::List m_mainWindows;
+    QHash<QString, DockWidgetBase*> m_dockWidgetsByName;
+    QHash<QString, MainWindowBase*> m_mainWindowsByName;
+    QHash<QWidget*, DockWidgetBase*> m_dockWidgetsByGuest;
+    QHash<DockWidgetBase*, QWidget*> m_guestsByDockWidget; // reverse of the above, so removal is O(1)
     Frame::List m_frames;
+    QVector<QPointer<Frame>> m_framesToReuse;
     QVector<FloatingWindow*> m_nestedWindows;
     QVector<MultiSplitterLayout*> m_layouts;
 };
@@ -26,6 +26,7 @@
 #include "WidgetResizeHandler_p.h"
 #include "Utils_p.h"
 #include "DockRegistry_p.h"
+#include "Config.h"
 
 #include <QMouseEvent>
 #include <QApplication>
@@ -169,6 +170,8 @@ bool StatePreDrag::handleMouseButtonRelease(QPoint)
 StateDragging::StateDragging(DragController *parent)
     : StateBase(parent)
 {
+    m_hoverTimer.setSingleShot(true);
+    connect(&m_hoverTimer, &QTimer::timeout, this, &StateDragging::flushHover);
 }
 
 StateDragging::~StateDragging() = default;
@@ -185,6 +188,12 @@ void StateDragging::onEntry(QEvent *)
     }
 }
 
+void StateDragging::onExit(QEvent *)
+{
+    m_hoverTimer.stop();
+    m_hoverPending = false;
+}
+
 bool StateDragging::handleMouseButtonRelease(QPoint globalPos)
 {
     qCDebug(state) << "StateDragging: handleMouseButtonRelease";
@@ -197,6 +206,13 @@ bool StateDragging::handleMouseButtonRelease(QPoint globalPos)
         return true;
     }
 
+    if (m_hoverPending) {
+        // Don't drop based on a stale hover, the release position is the one that counts
+        m_hoverTimer.stop();
+        m_hoverPending = false;
+        updateHover(globalPos);
+    }
+
     if (q->m_currentDropArea) {
         if (q->m_currentDropArea->drop(floatingWindow, globalPos)) {
             Q_EMIT q->dropped();
@@ -222,6 +238,39 @@ bool StateDragging::handleMouseMove(QPoint globalPos)
     if (!q->m_nonClientDrag)
         q->m_windowBeingDragged->floatingWindow()->windowHandle()->setPosition(globalPos - q->m_offset);
 
+    // Mouse events can arrive much faster than we can paint. Hover right away if we're idle,
+    // otherwise coalesce into a single hover when the interval elapses.
+    m_pendingHoverPos = globalPos;
+    if (m_hoverTimer.isActive()) {
+        m_hoverPending = true;
+        return true;
+    }
+
+    updateHover(globalPos);
+    if (const int interval = Config::self().dragHoverInterval())
+        m_hoverTimer.start(interval);
+
+    return true;
+}
+
+void StateDragging::flushHover()
+{
+    if (!m_hoverPending)
+        return;
+
+    m_hoverPending = false;
+    if (!q->m_windowBeingDragged->floatingWindow()) {
+        qCDebug(state) << "Canceling drag, window was deleted";
+        Q_EMIT q->dragCanceled();
+        return;
+    }
+
+    updateHover(m_pendingHoverPos);
+    m_hoverTimer.start(Config::self().dragHoverInterval());
+}
+
+void StateDragging::updateHover(QPoint globalPos)
+{
     DropArea *dropArea = q->dropAreaUnderCursor();
     if (q->m_currentDropArea && dropArea != q->m_currentDropArea)
         q->m_currentDropArea->removeHover();
@@ -230,8 +279,6 @@ bool StateDragging::handleMouseMove(QPoint globalPos)
         dropArea->hover(q->m_windowBeingDragged->floatingWindow(), globalPos);
 
     q->m_currentDropArea = dropArea;
-
-    return true;
 }
 
 DragController::DragController(QObject *)
@@ -382,13 +429,10 @@ StateBase *DragController::activeState() const
 }
 
 #if defined(Q_OS_WIN)
-static QWidget *qtTopLevelForHWND(HWND hwnd)
+static QWidget *qtTopLevelForHWND(HWND hwnd, const QHash<HWND, QWidget*> &topLevelsByHwnd)
 {
-    auto topLevels = qApp->topLevelWidgets();
-    for (auto topLevel : topLevels) {
-        if (hwnd == (HWND)topLevel->winId())
-            return topLevel;
-    }
+    if (QWidget *topLevel = topLevelsByHwnd.value(hwnd))
+        return topLevel;
 
     qCDebug(toplevels) << Q_FUNC_INFO << "Couldn't find hwnd for top-level" << hwnd;
     return nullptr;
@@ -425,6 +469,12 @@ QWidgetOrQuick *DragController::qtTopLevelUnderCursor() const
 
         // There might be windows that don't belong to our app in between, so use win32 to travel by z-order.
         // Another solution is to set a parent on all top-levels. But this code is orthogonal.
+        // Index the top-levels once, instead of scanning them for every window we walk through
+        QHash<HWND, QWidget*> topLevelsByHwnd;
+        topLevelsByHwnd.reserve(topLevels.size());
+        for (auto topLevel : qAsConst(topLevels))
+            topLevelsByHwnd.insert(HWND(topLevel->winId()), topLevel);
+
         HWND hwnd = HWND(m_windowBeingDragged->floatingWindow()->winId());
         while (hwnd) {
             hwnd = GetWindow(hwnd, GW_HWNDNEXT);
@@ -435,7 +485,7 @@ QWidgetOrQuick *DragController::qtTopLevelUnderCursor() const
             if (!PtInRect(&r, globalNativePos)) // Check if window is under cursor
                 continue;
 
-            if (auto tl = qtTopLevelForHWND(hwnd)) {
+            if (auto tl = qtTopLevelForHWND(hwnd, topLevelsByHwnd)) {
                 if (tl->geometry().contains(globalPos) && tl->objectName() != QStringLiteral("_docks_IndicatorWindow_Overlay")) {
                     qCDebug(toplevels) << Q_FUNC_INFO << "Found top-level" << tl;
                     return tl;
@@ -26,6 +26,7 @@
 #include "WindowBeingDragged_p.h"
 
 #include <QStateMachine>
+#include <QTimer>
 #include <QPoint>
 #include <memory>
 
@@ -135,8 +136,20 @@ public:
     explicit StateDragging(DragController *parent);
     ~StateDragging() override;
     void onEntry(QEvent *) override;
+    void onExit(QEvent *) override;
     bool handleMouseButtonRelease(QPoint globalPos) override;
     bool handleMouseMove(QPoint globalPos) override;
+
+private:
+    ///@brief Runs the pending hover, if any. Called once per Config::dragHoverInterval()
+    void flushHover();
+
+    ///@brief Hit tests the drop areas and updates the drop indicators. The expensive part of a drag.
+    void updateHover(QPoint globalPos);
+
+    QTimer m_hoverTimer;
+    QPoint m_pendingHoverPos;
+    bool m_hoverPending = false;
 };
 
 }
@@ -41,7 +41,6 @@ using namespace KDDockWidgets;
  */
 DropArea::DropArea(QWidgetOrQuick *parent)
     : MultiSplitter(parent)
-    , m_dropIndicatorOverlay(Config::self().frameworkWidgetFactory()->createDropIndicatorOverlay(this))
 {
     qCDebug(creation) << "DropArea";
     connect(m_layout, &MultiSplitterLayout::aboutToDumpDebug,
@@ -59,6 +58,15 @@ int DropArea::numFrames() const
     return m_layout->count();
 }
 
+DropIndicatorOverlayInterface *DropArea::dropIndicatorOverlay() const
+{
+    // Created on first hover, most drop areas are never dragged over
+    if (!m_dropIndicatorOverlay)
+        m_dropIndicatorOverlay = Config::self().frameworkWidgetFactory()->createDropIndicatorOverlay(const_cast<DropArea*>(this));
+
+    return m_dropIndicatorOverlay;
+}
+
 Anchor::List DropArea::nonStaticAnchors(bool includePlaceholders) const
 {
     auto anchors = m_layout->anchors();
@@ -73,17 +81,11 @@ Anchor::List DropArea::nonStaticAnchors(bool includePlaceholders) const
 
 Frame *DropArea::frameContainingPos(QPoint globalPos) const
 {
-    const ItemList &items = m_layout->items();
-    for (Item *item : items) {
-        auto frame = item->frame();
-        if (!frame || !frame->isVisible()) {
-            continue;
-        }
-
-        if (frame->containsMouse(globalPos))
-            return frame;
-    }
-    return nullptr;
+    // Frames are children of this widget and have the same geometry as their items,
+    // so map once and let the layout's spatial index do the lookup.
+    Item *item = m_layout->itemAt(mapFromGlobal(globalPos));
+    Frame *frame = item ? item->frame() : nullptr;
+    return frame && frame->isVisible() ? frame : nullptr;
 }
 
 Item *DropArea::centralFrame() const
@@ -178,10 +180,12 @@ void DropArea::hover(FloatingWindow *floatingWindow, QPoint globalPos)
     if (!validateAffinity(floatingWindow))
         return;
 
+    m_layout->setRectForDropCacheEnabled(true); // Until removeHover()
     Frame *frame = frameContainingPos(globalPos); // Frame is nullptr if MainWindowOption_HasCentralFrame isn't set
-    m_dropIndicatorOverlay->setWindowBeingDragged(floatingWindow);
-    m_dropIndicatorOverlay->setHoveredFrame(frame);
-    m_dropIndicatorOverlay->hover(globalPos);
+    DropIndicatorOverlayInterface *overlay = dropIndicatorOverlay();
+    overlay->setWindowBeingDragged(floatingWindow);
+    overlay->setHoveredFrame(frame);
+    overlay->hover(globalPos);
 }
 
 static bool isOutterLocation(DropIndicatorOverlayInterface::DropLocation location)
@@ -205,7 +209,7 @@ bool DropArea::drop(FloatingWindow *droppedWindow, QPoint globalPos)
         return false;
     }
 
-    if (m_dropIndicatorOverlay->currentDropLocation() == DropIndicatorOverlayInterface::DropLocation_None) {
+    if (!m_dropIndicatorOverlay || m_dropIndicatorOverlay->currentDropLocation() == DropIndicatorOverlayInterface::DropLocation_None) {
         qCDebug(hovering) << "DropArea::drop: bailing out, drop location = none";
         return false;
     }
@@ -284,6 +288,12 @@ bool DropArea::drop(QWidgetOrQuick *droppedWindow, KDDockWidgets::Location locat
 
 void DropArea::removeHover()
 {
+    // The next drag might carry a different window
+    m_layout->setRectForDropCacheEnabled(false);
+
+    if (!m_dropIndicatorOverlay)
+        return;
+
     m_dropIndicatorOverlay->setWindowBeingDragged(nullptr);
     m_dropIndicatorOverlay->setCurrentDropLocation(DropIndicatorOverlayInterface::DropLocation_None);
 }
@@ -61,7 +61,8 @@ public:
     Anchor::List nonStaticAnchors(bool includePlaceholders = false) const;
     Frame *frameContainingPos(QPoint globalPos) const;
     Item *centralFrame() const;
-    DropIndicatorOverlayInterface *dropIndicatorOverlay() const { return m_dropIndicatorOverlay; }
+    ///@brief Returns the drop indicator overlay, which is only created when first needed
+    DropIndicatorOverlayInterface *dropIndicatorOverlay() const;
     void addDockWidget(DockWidgetBase *, KDDockWidgets::Location location, DockWidgetBase *relativeTo, AddingOption option = {});
 
     void debug_updateItemNamesForGammaray();
@@ -80,7 +81,7 @@ private:
     bool validateAffinity(T *) const;
     bool m_inDestructor = false;
     QString m_affinityName;
-    DropIndicatorOverlayInterface *m_dropIndicatorOverlay = nullptr;
+    mutable DropIndicatorOverlayInterface *m_dropIndicatorOverlay = nullptr;
 };
 }
 
@@ -31,6 +31,7 @@
 #include "DockRegistry_p.h"
 #include "Config.h"
 #include "FrameworkWidgetFactory.h"
+#include "FloatingWindowPool_p.h"
 
 #include <QApplication>
 #include <QCloseEvent>
@@ -180,6 +181,21 @@ FloatingWindow::FloatingWindow(Frame *frame, MainWindowBase *parent)
     m_disableSetVisible = false;
 }
 
+void FloatingWindow::adoptFrame(Frame *frame)
+{
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    m_beingDeleted = false;
+    setParent(hackFindParentHarder(frame, nullptr), windowFlags());
+#endif
+    DockRegistry::self()->registerNestedWindow(this);
+    DockRegistry::self()->registerLayout(multiSplitterLayout());
+
+    // Same as in the ctor, don't let setVisible(true) place the window at 0,0
+    m_disableSetVisible = true;
+    multiSplitterLayout()->addWidget(frame, KDDockWidgets::Location_OnTop, {});
+    m_disableSetVisible = false;
+}
+
 FloatingWindow::~FloatingWindow()
 {
     disconnect(m_layoutDestroyedConnection);
@@ -226,7 +242,8 @@ void FloatingWindow::scheduleDeleteLater()
 {
     m_beingDeleted = true;
     DockRegistry::self()->unregisterNestedWindow(this);
-    deleteLater();
+    if (!FloatingWindowPool::self()->maybeRecycle(this))
+        deleteLater();
 }
 
 MultiSplitterLayout *FloatingWindow::multiSplitterLayout() const
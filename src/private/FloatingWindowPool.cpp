@@ -0,0 +1,190 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @brief A pool of pre-constructed FloatingWindows, to make tearing off dock widgets instant.
+ *
+ * @author Sérgio Martins \<sergio.martins@kdab.com\>
+ */
+
+#include "FloatingWindowPool_p.h"
+#include "FloatingWindow_p.h"
+#include "Frame_p.h"
+#include "DockWidgetBase.h"
+#include "LastPosition_p.h"
+#include "DockRegistry_p.h"
+#include "Config.h"
+#include "FrameworkWidgetFactory.h"
+#include "Logging_p.h"
+#include "multisplitter/MultiSplitterLayout_p.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <algorithm>
+
+using namespace KDDockWidgets;
+
+FloatingWindowPool::FloatingWindowPool(QObject *parent)
+    : QObject(parent)
+{
+    if (qApp) {
+        // Pooled windows have no parent, make sure they don't outlive the application
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &FloatingWindowPool::clear);
+    }
+}
+
+FloatingWindowPool::~FloatingWindowPool()
+{
+    clear();
+}
+
+FloatingWindowPool *FloatingWindowPool::self()
+{
+    static QPointer<FloatingWindowPool> s_pool;
+    if (!s_pool)
+        s_pool = new FloatingWindowPool(qApp);
+
+    return s_pool;
+}
+
+FloatingWindow *FloatingWindowPool::floatingWindowFor(Frame *frame)
+{
+    FloatingWindow *floatingWindow = nullptr;
+    while (!floatingWindow && !m_windows.isEmpty())
+        floatingWindow = m_windows.takeLast(); // might have been deleted externally
+
+    if (!floatingWindow)
+        return Config::self().frameworkWidgetFactory()->createFloatingWindow(frame);
+
+    qCDebug(creation) << Q_FUNC_INFO << "Reusing" << floatingWindow;
+    floatingWindow->adoptFrame(frame);
+    scheduleRefill();
+
+    return floatingWindow;
+}
+
+bool FloatingWindowPool::maybeRecycle(FloatingWindow *floatingWindow)
+{
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    if (m_windows.size() + m_pendingRecycles >= m_maxSize || QCoreApplication::closingDown())
+        return false;
+
+    // We're usually called while the window's layout is still emitting signals, so don't touch it now
+    m_pendingRecycles++;
+    QPointer<FloatingWindow> guard = floatingWindow;
+    QTimer::singleShot(0, this, [this, guard] {
+        m_pendingRecycles--;
+        if (guard)
+            finishRecycle(guard);
+        scheduleRefill(); // In case it wasn't pooled after all
+    });
+
+    return true;
+#else
+    Q_UNUSED(floatingWindow);
+    return false;
+#endif
+}
+
+void FloatingWindowPool::finishRecycle(FloatingWindow *floatingWindow)
+{
+    MultiSplitterLayout *layout = floatingWindow->multiSplitterLayout();
+    const Frame::List frames = floatingWindow->frames();
+    const bool hasLiveFrames = std::any_of(frames.cbegin(), frames.cend(), [] (Frame *frame) {
+        return !frame->beingDeletedLater();
+    });
+
+    if (m_windows.size() >= m_maxSize || layout->visibleCount() > 0 || hasLiveFrames) {
+        floatingWindow->deleteLater();
+        return;
+    }
+
+    if (layout->count() > 0) {
+        // Closed dock widgets leave placeholders behind. Forget them, just like deleting the window would.
+        const DockWidgetBase::List dockWidgets = DockRegistry::self()->dockwidgets();
+        for (DockWidgetBase *dw : dockWidgets)
+            dw->lastPosition()->removePlaceholders(layout);
+        layout->clear();
+    }
+
+    park(floatingWindow);
+}
+
+void FloatingWindowPool::park(FloatingWindow *floatingWindow)
+{
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    // Layout first, as unregistering the last window might delete the registry
+    DockRegistry::self()->unregisterLayout(floatingWindow->multiSplitterLayout());
+    DockRegistry::self()->unregisterNestedWindow(floatingWindow);
+    floatingWindow->hide();
+    floatingWindow->setParent(nullptr, floatingWindow->windowFlags());
+    m_windows.push_back(floatingWindow);
+#else
+    Q_UNUSED(floatingWindow);
+#endif
+}
+
+void FloatingWindowPool::setMaxSize(int maxSize)
+{
+    m_maxSize = qMax(0, maxSize);
+
+    while (m_windows.size() > m_maxSize)
+        delete m_windows.takeLast();
+
+    scheduleRefill();
+}
+
+int FloatingWindowPool::size() const
+{
+    return m_windows.size();
+}
+
+void FloatingWindowPool::scheduleRefill()
+{
+    if (m_refillScheduled || m_windows.size() + m_pendingRecycles >= m_maxSize || !qApp)
+        return;
+
+    // Construct them when idle, not while the user is dragging
+    m_refillScheduled = true;
+    QTimer::singleShot(0, this, &FloatingWindowPool::refill);
+}
+
+void FloatingWindowPool::refill()
+{
+    m_refillScheduled = false;
+
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    // Windows being recycled will take the remaining slots
+    while (m_windows.size() + m_pendingRecycles < m_maxSize) {
+        FloatingWindow *floatingWindow = Config::self().frameworkWidgetFactory()->createFloatingWindow();
+        park(floatingWindow);
+    }
+#endif
+}
+
+void FloatingWindowPool::clear()
+{
+    const auto windows = m_windows;
+    m_windows.clear();
+    for (FloatingWindow *floatingWindow : windows)
+        delete floatingWindow;
+}
@@ -0,0 +1,89 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KD_FLOATINGWINDOWPOOL_P_H
+#define KD_FLOATINGWINDOWPOOL_P_H
+
+#include "docks_export.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+namespace KDDockWidgets {
+
+class FloatingWindow;
+class Frame;
+
+/**
+ * @brief Keeps a few hidden FloatingWindows around, so tearing off a dock widget doesn't have to
+ * construct one from scratch.
+ *
+ * Opt-in via Config::setFloatingWindowPoolSize(). Pooled windows aren't registered in the DockRegistry,
+ * so they're invisible to the rest of the framework until they're taken out.
+ */
+class DOCKS_EXPORT_FOR_UNIT_TESTS FloatingWindowPool : public QObject
+{
+    Q_OBJECT
+public:
+    static FloatingWindowPool *self();
+    ~FloatingWindowPool() override;
+
+    /**
+     * @brief Returns a FloatingWindow hosting @p frame.
+     *
+     * Takes a window from the pool if there's one available, otherwise one is created via the
+     * FrameworkWidgetFactory. The pool is then refilled in the background.
+     */
+    FloatingWindow *floatingWindowFor(Frame *frame);
+
+    /**
+     * @brief Called when @p floatingWindow is about to be deleted.
+     *
+     * Returns true if the pool takes care of it, in which case it will either be returned to the
+     * pool or deleted later. Returns false if the caller should delete it.
+     * Windows left with only placeholders, because their dock widgets were closed, have the
+     * placeholders cleared before being pooled.
+     */
+    bool maybeRecycle(FloatingWindow *floatingWindow);
+
+    ///@brief Sets the number of windows to keep around. 0 disables the pool and deletes the pooled windows.
+    void setMaxSize(int);
+
+    ///@brief Returns the number of windows currently pooled
+    int size() const;
+
+private:
+    explicit FloatingWindowPool(QObject *parent = nullptr);
+    void scheduleRefill();
+    void refill();
+    void park(FloatingWindow *);
+    void finishRecycle(FloatingWindow *);
+    void clear();
+
+    QVector<QPointer<FloatingWindow>> m_windows;
+    int m_maxSize = 0;
+    int m_pendingRecycles = 0;
+    bool m_refillScheduled = false;
+};
+
+}
+
+#endif
@@ -124,6 +124,9 @@ protected:
     DropArea *const m_dropArea;
 private:
     Q_DISABLE_COPY(FloatingWindow)
+    friend class FloatingWindowPool;
+    ///@brief Called by FloatingWindowPool when a pooled window is taken out to host @p frame
+    void adoptFrame(Frame *frame);
     void maybeCreateResizeHandler();
     void onFrameCountChanged(int count);
     void onVisibleFrameCountChanged(int count);
@@ -36,6 +36,7 @@
 #include "DockRegistry_p.h"
 #include "Config.h"
 #include "FrameworkWidgetFactory.h"
+#include "HibernationManager_p.h"
 
 #include <QTabBar>
 #include <QCloseEvent>
@@ -182,6 +183,9 @@ void Frame::onDockWidgetCountChanged()
         // We don't really keep track of the state, so emit even if the visibility didn't change. No biggie.
         if (!(m_options & FrameOption_AlwaysShowsTabs))
             Q_EMIT hasTabsVisibleChanged();
+
+        // Tabs added behind the current one are inactive already
+        HibernationManager::self()->onCurrentTabChanged(this);
     }
 
     Q_EMIT numDockWidgetsChanged();
@@ -191,6 +195,9 @@ void Frame::onCurrentTabChanged(int index)
 {
     if (index != -1) {
         if (auto dock = dockWidgetAt(index)) {
+            // Lazy dock widgets get their widget as soon as they become current, before being shown
+            dock->ensureWidget();
+            HibernationManager::self()->onCurrentTabChanged(this);
             Q_EMIT currentDockWidgetChanged(dock);
         } else {
             qWarning() << "dockWidgetAt" << index << "returned nullptr" << this;
@@ -493,21 +500,44 @@ bool Frame::event(QEvent *e)
 
 Frame *Frame::deserialize(const LayoutSaver::Frame &f)
 {
-    auto frame = Config::self().frameworkWidgetFactory()->createFrame(/*parent=*/nullptr, FrameOptions(f.options));
-    frame->setObjectName(f.objectName);
-
-    for (const auto &savedDock : qAsConst(f.dockWidgets)) {
-        if (DockWidgetBase *dw = DockWidgetBase::deserialize(savedDock)) {
-            frame->addWidget(dw);
+    // With RestoreOption_Incremental, a frame already showing these dock widgets might have been kept
+    Frame *frame = DockRegistry::self()->takeFrameToReuse(f);
+    if (frame) {
+        for (const auto &savedDock : qAsConst(f.dockWidgets))
+            DockWidgetBase::deserialize(savedDock);
+    } else {
+        frame = Config::self().frameworkWidgetFactory()->createFrame(/*parent=*/nullptr, FrameOptions(f.options));
+        for (const auto &savedDock : qAsConst(f.dockWidgets)) {
+            if (DockWidgetBase *dw = DockWidgetBase::deserialize(savedDock)) {
+                frame->addWidget(dw);
+            }
         }
     }
 
+    frame->setObjectName(f.objectName);
     frame->setCurrentTabIndex(f.currentTabIndex);
     frame->setGeometry(f.geometry);
 
     return frame;
 }
 
+bool Frame::hasSameDockWidgets(const LayoutSaver::Frame &saved) const
+{
+    if (saved.isNull || saved.options != options())
+        return false;
+
+    const DockWidgetBase::List docks = dockWidgets();
+    if (docks.size() != saved.dockWidgets.size())
+        return false;
+
+    for (int i = 0; i < docks.size(); ++i) {
+        if (docks.at(i)->uniqueName() != saved.dockWidgets.at(i)->uniqueName)
+            return false;
+    }
+
+    return true;
+}
+
 LayoutSaver::Frame Frame::serialize() const
 {
     LayoutSaver::Frame frame;
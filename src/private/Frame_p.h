@@ -70,6 +70,9 @@ public:
     static Frame *deserialize(const LayoutSaver::Frame &);
     LayoutSaver::Frame serialize() const;
 
+    ///@brief Returns whether this frame shows the same dock widgets as @p saved, in the same order. See RestoreOption_Incremental.
+    bool hasSameDockWidgets(const LayoutSaver::Frame &saved) const;
+
     ///@brief Adds a widget into the Frame's TabWidget
     void addWidget(DockWidgetBase *, AddingOption = AddingOption_None);
     ///@overload
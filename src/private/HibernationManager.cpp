@@ -0,0 +1,223 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @brief Releases the state of dock widgets that have been non-current tabs for too long.
+ *
+ * @author Sérgio Martins \<sergio.martins@kdab.com\>
+ */
+
+#include "HibernationManager_p.h"
+#include "DockWidgetBase.h"
+#include "Frame_p.h"
+#include "Config.h"
+#include "Logging_p.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+
+using namespace KDDockWidgets;
+
+static int hibernationTimeoutFor(DockWidgetBase *dw)
+{
+    const int timeout = dw->hibernationTimeout();
+    return timeout >= 0 ? timeout : Config::self().tabHibernationTimeout();
+}
+
+HibernationManager::HibernationManager(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &HibernationManager::checkInactiveTabs);
+}
+
+HibernationManager::~HibernationManager()
+{
+}
+
+HibernationManager *HibernationManager::self()
+{
+    static QPointer<HibernationManager> s_manager;
+    if (!s_manager)
+        s_manager = new HibernationManager(qApp);
+
+    return s_manager;
+}
+
+void HibernationManager::onCurrentTabChanged(Frame *frame)
+{
+    DockWidgetBase *current = frame->currentDockWidget();
+    const auto dockWidgets = frame->dockWidgets();
+    for (DockWidgetBase *dw : dockWidgets) {
+        if (!dw->canHibernate())
+            continue;
+
+        if (dw == current) {
+            untrack(dw);
+            wakeUp(dw);
+        } else if (!dw->isHibernating() && !isTracked(dw)) {
+            m_inactive.push_back({ dw, m_clock.elapsed() });
+        }
+    }
+
+    checkInactiveTabs();
+}
+
+void HibernationManager::wakeUp(DockWidgetBase *dw)
+{
+    if (!dw->isHibernating())
+        return;
+
+    m_hibernated.removeAll(dw);
+    dw->wakeUp();
+}
+
+void HibernationManager::track(DockWidgetBase *dw)
+{
+    if (!dw->canHibernate() || dw->isHibernating() || !dw->frame() || dw->isCurrentTab() || isTracked(dw))
+        return;
+
+    m_inactive.push_back({ dw, m_clock.elapsed() });
+    checkInactiveTabs();
+}
+
+void HibernationManager::untrack(DockWidgetBase *dw)
+{
+    m_inactive.erase(std::remove_if(m_inactive.begin(), m_inactive.end(), [dw] (const Entry &entry) {
+        return entry.dockWidget == dw;
+    }), m_inactive.end());
+    m_hibernated.removeAll(dw);
+}
+
+void HibernationManager::checkInactiveTabs()
+{
+    prune();
+
+    // Hibernate the ones that timed out
+    const qint64 now = m_clock.elapsed();
+    for (int i = m_inactive.size() - 1; i >= 0; --i) {
+        DockWidgetBase *dw = m_inactive.at(i).dockWidget;
+        const int timeout = hibernationTimeoutFor(dw);
+        if (timeout >= 0 && now - m_inactive.at(i).inactiveSince >= timeout) {
+            m_inactive.removeAt(i);
+            hibernate(dw);
+        }
+    }
+
+    // Then the least recently used ones, until we're within budget
+    const qint64 maxMemory = Config::self().maxInactiveTabsMemory();
+    if (maxMemory >= 0) {
+        qint64 memory = inactiveMemory();
+        while (memory > maxMemory && !m_inactive.isEmpty()) {
+            DockWidgetBase *dw = m_inactive.takeFirst().dockWidget;
+            memory -= dw->memoryCost();
+            hibernate(dw);
+        }
+    }
+
+    scheduleCheck();
+}
+
+void HibernationManager::onSettingsChanged()
+{
+    // The timer might be stopped, or waiting for a deadline that changed
+    checkInactiveTabs();
+}
+
+qint64 HibernationManager::inactiveMemory() const
+{
+    qint64 result = 0;
+    for (const Entry &entry : m_inactive) {
+        if (entry.dockWidget)
+            result += entry.dockWidget->memoryCost();
+    }
+
+    return result;
+}
+
+qint64 HibernationManager::hibernatedMemory() const
+{
+    qint64 result = 0;
+    for (const QPointer<DockWidgetBase> &dw : m_hibernated) {
+        if (dw)
+            result += dw->memoryCost();
+    }
+
+    return result;
+}
+
+int HibernationManager::numInactive() const
+{
+    return m_inactive.size();
+}
+
+int HibernationManager::numHibernated() const
+{
+    return m_hibernated.size();
+}
+
+bool HibernationManager::isTracked(DockWidgetBase *dw) const
+{
+    for (const Entry &entry : m_inactive) {
+        if (entry.dockWidget == dw)
+            return true;
+    }
+
+    return false;
+}
+
+void HibernationManager::hibernate(DockWidgetBase *dw)
+{
+    dw->hibernate();
+    if (dw->isHibernating())
+        m_hibernated.push_back(dw);
+}
+
+void HibernationManager::prune()
+{
+    // Forget the ones that were deleted, closed, or became current behind our back
+    m_inactive.erase(std::remove_if(m_inactive.begin(), m_inactive.end(), [] (const Entry &entry) {
+        DockWidgetBase *dw = entry.dockWidget;
+        return !dw || !dw->canHibernate() || !dw->frame() || dw->isCurrentTab();
+    }), m_inactive.end());
+    m_hibernated.removeAll(nullptr);
+}
+
+void HibernationManager::scheduleCheck()
+{
+    qint64 nextDeadline = -1;
+    for (const Entry &entry : qAsConst(m_inactive)) {
+        const int timeout = hibernationTimeoutFor(entry.dockWidget);
+        if (timeout < 0)
+            continue;
+        const qint64 deadline = entry.inactiveSince + timeout;
+        if (nextDeadline == -1 || deadline < nextDeadline)
+            nextDeadline = deadline;
+    }
+
+    if (nextDeadline == -1) {
+        m_timer.stop();
+    } else {
+        m_timer.start(int(qMax<qint64>(0, nextDeadline - m_clock.elapsed())));
+    }
+}
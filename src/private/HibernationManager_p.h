@@ -0,0 +1,103 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KD_HIBERNATIONMANAGER_P_H
+#define KD_HIBERNATIONMANAGER_P_H
+
+#include "docks_export.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+namespace KDDockWidgets {
+
+class DockWidgetBase;
+class Frame;
+
+/**
+ * @brief Hibernates dock widgets that have been non-current tabs for too long.
+ *
+ * Only dock widgets with hibernation callbacks are considered, see
+ * DockWidgetBase::setHibernationCallbacks(). The inactive ones are kept in least recently used
+ * order, so when Config::maxInactiveTabsMemory() is exceeded the oldest ones hibernate first.
+ */
+class DOCKS_EXPORT_FOR_UNIT_TESTS HibernationManager : public QObject
+{
+    Q_OBJECT
+public:
+    static HibernationManager *self();
+    ~HibernationManager() override;
+
+    ///@brief Called by Frame when its current tab changed. Wakes up the current one and starts
+    /// the hibernation countdown for the others.
+    void onCurrentTabChanged(Frame *frame);
+
+    ///@brief Wakes up @p dw if it's hibernating
+    void wakeUp(DockWidgetBase *dw);
+
+    ///@brief Starts the hibernation countdown for @p dw if it's a non-current tab, for when it
+    /// opts in after its frame already changed tabs
+    void track(DockWidgetBase *dw);
+
+    ///@brief Stops tracking @p dw, for when it's deleted or opts out
+    void untrack(DockWidgetBase *dw);
+
+    ///@brief Called when a timeout, budget or memory cost changed, so it takes effect right away
+    void onSettingsChanged();
+
+    ///@brief Hibernates the inactive tabs that timed out or don't fit in the memory budget
+    void checkInactiveTabs();
+
+    ///@brief Returns the memory cost of the awake, non-current tabs
+    qint64 inactiveMemory() const;
+
+    ///@brief Returns the memory cost released by the hibernating dock widgets
+    qint64 hibernatedMemory() const;
+
+    ///@brief Returns the number of awake, non-current tabs that can hibernate
+    int numInactive() const;
+
+    ///@brief Returns the number of hibernating dock widgets
+    int numHibernated() const;
+
+private:
+    struct Entry {
+        QPointer<DockWidgetBase> dockWidget;
+        qint64 inactiveSince;
+    };
+
+    explicit HibernationManager(QObject *parent = nullptr);
+    bool isTracked(DockWidgetBase *) const;
+    void hibernate(DockWidgetBase *);
+    void prune();
+    void scheduleCheck();
+
+    QVector<Entry> m_inactive; // least recently used first
+    QVector<QPointer<DockWidgetBase>> m_hibernated;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
+
+}
+
+#endif
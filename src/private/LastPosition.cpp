@@ -60,7 +60,7 @@ void LastPosition::addPlaceholderItem(Item *placeholder)
         removePlaceholder(placeholder);
     });
 
-    m_placeholders.push_back(std::unique_ptr<ItemRef>(new ItemRef(connection, placeholder)));
+    m_placeholders.push_back(std::unique_ptr<ItemRef>(new ItemRef(connection, placeholder, this)));
 
     // NOTE: We use a list instead of simply two variables to keep the placeholders, because
     // a placeholder from a FloatingWindow might become a MainWindow one without we knowing,
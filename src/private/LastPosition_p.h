@@ -37,28 +37,32 @@
 
 namespace KDDockWidgets {
 
+class LastPosition;
+
 // Just a RAII class so we don't forget to unref
 struct ItemRef
 {
-    ItemRef(const QMetaObject::Connection &conn, Item *it)
+    ItemRef(const QMetaObject::Connection &conn, Item *it, LastPosition *owner)
         : item(it)
         , guard(it)
         , connection(conn)
+        , lastPosition(owner)
     {
-        item->ref();
+        item->ref(lastPosition);
     }
 
     ~ItemRef()
     {
         if (guard) {
             QObject::disconnect(connection);
-            item->unref();
+            item->unref(lastPosition);
         }
     }
 
     Item *const item;
     const QPointer<Item> guard;
     const QMetaObject::Connection connection;
+    LastPosition *const lastPosition;
 private:
     Q_DISABLE_COPY(ItemRef)
 };
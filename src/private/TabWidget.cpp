@@ -29,6 +29,7 @@
 #include "TabWidget_p.h"
 #include "DragController_p.h"
 #include "FloatingWindow_p.h"
+#include "FloatingWindowPool_p.h"
 #include "Frame_p.h"
 #include "WindowBeingDragged_p.h"
 #include "Logging_p.h"
@@ -111,7 +112,7 @@ FloatingWindow * TabBar::detachTab(DockWidgetBase *dockWidget)
 
     // We're potentially already dead at this point, as frames with 0 tabs auto-destruct. Don't access members from this point.
 
-    auto floatingWindow = Config::self().frameworkWidgetFactory()->createFloatingWindow(newFrame);
+    auto floatingWindow = FloatingWindowPool::self()->floatingWindowFor(newFrame);
     r.moveTopLeft(globalPoint);
     floatingWindow->setGeometry(r);
     floatingWindow->show();
@@ -224,7 +225,7 @@ std::unique_ptr<WindowBeingDragged> TabWidget::makeWindow()
 
     const QPoint globalPoint = m_thisWidget->mapToGlobal(QPoint(0, 0));
 
-    auto floatingWindow = Config::self().frameworkWidgetFactory()->createFloatingWindow(m_frame);
+    auto floatingWindow = FloatingWindowPool::self()->floatingWindowFor(m_frame);
     r.moveTopLeft(globalPoint);
     floatingWindow->setGeometry(r);
     floatingWindow->show();
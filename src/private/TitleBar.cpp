@@ -22,6 +22,7 @@
 #include "DragController_p.h"
 #include "Frame_p.h"
 #include "FloatingWindow_p.h"
+#include "FloatingWindowPool_p.h"
 #include "Logging_p.h"
 #include "WindowBeingDragged_p.h"
 #include "Utils_p.h"
@@ -133,7 +134,7 @@ std::unique_ptr<WindowBeingDragged> TitleBar::makeWindow()
     qCDebug(hovering) << "TitleBar::makeWindow original geometry" << r;
     r.moveTopLeft(m_frame->mapToGlobal(QPoint(0, 0)));
 
-    auto floatingWindow = Config::self().frameworkWidgetFactory()->createFloatingWindow(m_frame);
+    auto floatingWindow = FloatingWindowPool::self()->floatingWindowFor(m_frame);
     floatingWindow->setGeometry(r);
     floatingWindow->show();
     qCDebug(hovering) << "TitleBar::makeWindow setting geometry" << r << "actual=" << floatingWindow->geometry();
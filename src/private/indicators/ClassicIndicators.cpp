@@ -26,6 +26,8 @@
 #include "Utils_p.h"
 
 #include <QPainter>
+#include <QPixmapCache>
+#include <QPointer>
 #include <QRubberBand>
 
 #define INDICATOR_WIDTH 40
@@ -38,14 +40,32 @@ namespace KDDockWidgets {
 class IndicatorWindow;
 }
 
+static QPointer<IndicatorWindow> s_indicatorWindow;
+static int s_classicIndicatorsCount = 0;
+
+/// @brief Returns the scaled indicator image, decoding it only once per name, translucency and DPR
+static QPixmap indicatorPixmap(const QString &iconName, qreal dpr)
+{
+    const bool translucency = KDDockWidgets::windowManagerHasTranslucency();
+    const QString key = QStringLiteral("kddockwidgets_indicator_%1_%2_%3").arg(iconName).arg(int(translucency)).arg(dpr);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        const QString fileName = translucency ? QStringLiteral(":/img/classic_indicators/%1.png").arg(iconName)
+                                              : QStringLiteral(":/img/classic_indicators/opaque/%1.png").arg(iconName);
+        const int length = qRound(INDICATOR_WIDTH * dpr);
+        pixmap = QPixmap::fromImage(QImage(fileName).scaled(length, length));
+        pixmap.setDevicePixelRatio(dpr);
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    return pixmap;
+}
+
 void Indicator::paintEvent(QPaintEvent *)
 {
     QPainter p(this);
-    if (m_hovered)
-        p.drawImage(rect(), m_imageActive, rect());
-    else
-        p.drawImage(rect(), m_image, rect());
-
+    p.drawPixmap(rect(), indicatorPixmap(iconName(m_hovered), devicePixelRatioF()));
 }
 
 void Indicator::setHovered(bool hovered)
@@ -53,6 +73,10 @@ void Indicator::setHovered(bool hovered)
     if (hovered != m_hovered) {
         m_hovered = hovered;
         update();
+        ClassicIndicators *q = m_indicatorWindow->classicIndicators;
+        if (!q)
+            return;
+
         if (hovered) {
             q->setDropLocation(m_dropLocation);
         } else if (q->currentDropLocation() == m_dropLocation) {
@@ -102,29 +126,20 @@ QString Indicator::iconName(bool active) const
     return name + suffix;
 }
 
-QString Indicator::iconFileName(bool active) const
-{
-    const QString name = iconName(active);
-    return KDDockWidgets::windowManagerHasTranslucency() ? QStringLiteral(":/img/classic_indicators/%1.png").arg(name)
-                                                         : QStringLiteral(":/img/classic_indicators/opaque/%1.png").arg(name);
-}
-
-IndicatorWindow::IndicatorWindow(ClassicIndicators *classicIndicators_, QWidget *)
+IndicatorWindow::IndicatorWindow(QWidget *)
     : QWidget(nullptr, Qt::Tool | Qt::BypassWindowManagerHint)
-    , classicIndicators(classicIndicators_)
-    , m_center(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_Center)) // Each indicator is not a top-level. Otherwise there's noticeable delay.
-    , m_left(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_Left))
-    , m_right(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_Right))
-    , m_bottom(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_Bottom))
-    , m_top(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_Top))
-    , m_outterLeft(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_OutterLeft))
-    , m_outterRight(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_OutterRight))
-    , m_outterBottom(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_OutterBottom))
-    , m_outterTop(new Indicator(classicIndicators, this, DropIndicatorOverlayInterface::DropLocation_OutterTop))
+    , m_center(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_Center)) // Each indicator is not a top-level. Otherwise there's noticeable delay.
+    , m_left(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_Left))
+    , m_right(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_Right))
+    , m_bottom(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_Bottom))
+    , m_top(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_Top))
+    , m_outterLeft(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_OutterLeft))
+    , m_outterRight(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_OutterRight))
+    , m_outterBottom(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_OutterBottom))
+    , m_outterTop(new Indicator(this, DropIndicatorOverlayInterface::DropLocation_OutterTop))
 {
     setWindowFlag(Qt::FramelessWindowHint, true);
     setAttribute(Qt::WA_TranslucentBackground);
-    updatePosition();
 
     m_indicators << m_center << m_left << m_right << m_top << m_bottom
                  << m_outterBottom << m_outterTop << m_outterLeft << m_outterRight;
@@ -132,6 +147,23 @@ IndicatorWindow::IndicatorWindow(ClassicIndicators *classicIndicators_, QWidget
     setObjectName(QStringLiteral("_docks_IndicatorWindow_Overlay"));
 }
 
+void IndicatorWindow::setClassicIndicators(ClassicIndicators *ci)
+{
+    if (ci == classicIndicators)
+        return;
+
+    classicIndicators = ci;
+
+    // Hover state belonged to the previous drop area
+    for (Indicator *indicator : qAsConst(m_indicators)) {
+        indicator->m_hovered = false;
+        indicator->update();
+    }
+
+    if (classicIndicators)
+        updatePosition();
+}
+
 bool IndicatorWindow::event(QEvent *e)
 {
     if (e->type() == QEvent::Show) {
@@ -191,7 +223,7 @@ void IndicatorWindow::resizeEvent(QResizeEvent *ev)
 
 void IndicatorWindow::updateIndicatorVisibility(bool visible)
 {
-    Frame *hoveredFrame = classicIndicators->m_hoveredFrame;
+    Frame *hoveredFrame = classicIndicators ? classicIndicators->m_hoveredFrame : nullptr;
     const bool isTheOnlyFrame = hoveredFrame && hoveredFrame->isTheOnlyFrame();
 
     const bool innerShouldBeVisible = visible && hoveredFrame;
@@ -216,6 +248,9 @@ void IndicatorWindow::hover(QPoint globalPos)
 
 void IndicatorWindow::updatePosition()
 {
+    if (!classicIndicators)
+        return;
+
     QRect rect = classicIndicators->rect();
     QPoint pos = classicIndicators->mapToGlobal(QPoint(0, 0));
     rect.moveTo(pos);
@@ -232,7 +267,7 @@ void IndicatorWindow::updatePositions()
     m_outterBottom->move(r.center().x() - halfIndicatorWidth, r.y() + height() - indicatorWidth - OUTTER_INDICATOR_MARGIN);
     m_outterTop->move(r.center().x() - halfIndicatorWidth, r.y() + OUTTER_INDICATOR_MARGIN);
     m_outterRight->move(r.x() + width() - indicatorWidth - OUTTER_INDICATOR_MARGIN, r.center().y() - halfIndicatorWidth);
-    Frame *hoveredFrame = classicIndicators->m_hoveredFrame;
+    Frame *hoveredFrame = classicIndicators ? classicIndicators->m_hoveredFrame : nullptr;
     if (hoveredFrame) {
         QRect hoveredRect = hoveredFrame->geometry();
         m_center->move(r.topLeft() + hoveredRect.center() - QPoint(halfIndicatorWidth, halfIndicatorWidth));
@@ -243,22 +278,21 @@ void IndicatorWindow::updatePositions()
     }
 }
 
-Indicator::Indicator(ClassicIndicators *classicIndicators, IndicatorWindow *parent, ClassicIndicators::DropLocation location)
+Indicator::Indicator(IndicatorWindow *parent, ClassicIndicators::DropLocation location)
     : QWidget(parent)
-    , q(classicIndicators)
+    , m_indicatorWindow(parent)
     , m_dropLocation(location)
 {
-    m_image = QImage(iconFileName(/*active=*/ false)).scaled(INDICATOR_WIDTH, INDICATOR_WIDTH);
-    m_imageActive = QImage(iconFileName(/*active=*/ true)).scaled(INDICATOR_WIDTH, INDICATOR_WIDTH);
-    setFixedSize(m_image.size());
+    // The image itself is only loaded when painting, see indicatorPixmap()
+    setFixedSize(INDICATOR_WIDTH, INDICATOR_WIDTH);
     setVisible(true);
 }
 
 ClassicIndicators::ClassicIndicators(DropArea *dropArea)
     : DropIndicatorOverlayInterface(dropArea) // Is parented on the drop-area, not a toplevel.
     , m_rubberBand(new QRubberBand(QRubberBand::Rectangle, rubberBandIsTopLevel() ? nullptr : dropArea))
-    , m_indicatorWindow(new IndicatorWindow(this, /*parent=*/ nullptr)) // Top-level so the indicators can appear above the window being dragged.
 {
+    s_classicIndicatorsCount++;
     setVisible(false);
     if (rubberBandIsTopLevel())
         m_rubberBand->setWindowOpacity(0.5);
@@ -266,7 +300,27 @@ ClassicIndicators::ClassicIndicators(DropArea *dropArea)
 
 ClassicIndicators::~ClassicIndicators()
 {
-    delete m_indicatorWindow;
+    if (ownsIndicatorWindow()) {
+        s_indicatorWindow->setVisible(false);
+        s_indicatorWindow->setClassicIndicators(nullptr);
+    }
+
+    s_classicIndicatorsCount--;
+    if (s_classicIndicatorsCount == 0)
+        delete s_indicatorWindow;
+}
+
+IndicatorWindow *ClassicIndicators::indicatorWindow()
+{
+    if (!s_indicatorWindow)
+        s_indicatorWindow = new IndicatorWindow(/*parent=*/ nullptr); // Top-level so the indicators can appear above the window being dragged.
+
+    return s_indicatorWindow;
+}
+
+bool ClassicIndicators::ownsIndicatorWindow() const
+{
+    return s_indicatorWindow && s_indicatorWindow->classicIndicators == this;
 }
 
 DropIndicatorOverlayInterface::Type ClassicIndicators::indicatorType() const
@@ -276,26 +330,35 @@ DropIndicatorOverlayInterface::Type ClassicIndicators::indicatorType() const
 
 void ClassicIndicators::hover(QPoint globalPos)
 {
-    m_indicatorWindow->hover(globalPos);
+    if (ownsIndicatorWindow())
+        s_indicatorWindow->hover(globalPos);
 }
 
 QPoint ClassicIndicators::posForIndicator(DropIndicatorOverlayInterface::DropLocation loc) const
 {
-    Indicator *indicator = m_indicatorWindow->indicatorForLocation(loc);
+    if (!ownsIndicatorWindow())
+        return {};
+
+    Indicator *indicator = s_indicatorWindow->indicatorForLocation(loc);
     return indicator->mapToGlobal(indicator->rect().center());
 }
 
 void ClassicIndicators::updateVisibility()
 {
     if (isHovered()) {
-        m_indicatorWindow->updatePositions();
-        m_indicatorWindow->setVisible(true);
-        m_indicatorWindow->updateIndicatorVisibility(true);
+        IndicatorWindow *indicatorWindow = ClassicIndicators::indicatorWindow();
+        indicatorWindow->setClassicIndicators(this);
+        indicatorWindow->updatePositions();
+        indicatorWindow->setVisible(true);
+        indicatorWindow->updateIndicatorVisibility(true);
         raiseIndicators();
     } else {
         m_rubberBand->setVisible(false);
-        m_indicatorWindow->setVisible(false);
-        m_indicatorWindow->updateIndicatorVisibility(false);
+        if (ownsIndicatorWindow()) {
+            s_indicatorWindow->setVisible(false);
+            s_indicatorWindow->updateIndicatorVisibility(false);
+            s_indicatorWindow->setClassicIndicators(nullptr);
+        }
     }
 }
 
@@ -312,12 +375,14 @@ void ClassicIndicators::hideEvent(QHideEvent *e)
 void ClassicIndicators::resizeEvent(QResizeEvent *ev)
 {
     QWidget::resizeEvent(ev);
-    m_indicatorWindow->resize(window()->size());
+    if (ownsIndicatorWindow())
+        s_indicatorWindow->resize(window()->size());
 }
 
 void ClassicIndicators::raiseIndicators()
 {
-    m_indicatorWindow->raise();
+    if (ownsIndicatorWindow())
+        s_indicatorWindow->raise();
 }
 
 KDDockWidgets::Location locationToMultisplitterLocation(ClassicIndicators::DropLocation location)
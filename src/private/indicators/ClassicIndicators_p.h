@@ -54,15 +54,27 @@ private:
     QRect geometryForRubberband(QRect localRect) const;
     bool rubberBandIsTopLevel() const;
 
+    ///@brief Returns the IndicatorWindow shared by all ClassicIndicators, created on first use
+    static IndicatorWindow *indicatorWindow();
+
+    ///@brief Returns whether the shared IndicatorWindow is currently showing our indicators
+    bool ownsIndicatorWindow() const;
+
     QRubberBand *const m_rubberBand;
-    IndicatorWindow *const m_indicatorWindow;
 };
 
+/**
+ * @brief The top-level window with the drop indicators.
+ *
+ * Only one drop area is hovered at a time, so a single instance is shared by all ClassicIndicators.
+ * It's attached to the ClassicIndicators being hovered via setClassicIndicators().
+ */
 class IndicatorWindow : public QWidget
 {
     Q_OBJECT
 public:
-    explicit IndicatorWindow(ClassicIndicators *classicIndicators, QWidget * = nullptr);
+    explicit IndicatorWindow(QWidget * = nullptr);
+    void setClassicIndicators(ClassicIndicators *);
     void hover(QPoint globalPos);
 
     void updatePosition();
@@ -77,7 +89,7 @@ public:
     // Only happens on Linux
     void updateMask();
 
-    ClassicIndicators *const classicIndicators;
+    ClassicIndicators *classicIndicators = nullptr;
     Indicator *const m_center;
     Indicator *const m_left;
     Indicator *const m_right;
@@ -95,16 +107,13 @@ class Indicator : public QWidget
     Q_OBJECT
 public:
     typedef QList<Indicator *> List;
-    explicit Indicator(ClassicIndicators *classicIndicators, IndicatorWindow *parent, ClassicIndicators::DropLocation location);
+    explicit Indicator(IndicatorWindow *parent, ClassicIndicators::DropLocation location);
     void paintEvent(QPaintEvent *) override;
 
     void setHovered(bool hovered);
     QString iconName(bool active) const;
-    QString iconFileName(bool active) const;
 
-    QImage m_image;
-    QImage m_imageActive;
-    ClassicIndicators *const q;
+    IndicatorWindow *const m_indicatorWindow;
     bool m_hovered = false;
     const ClassicIndicators::DropLocation m_dropLocation;
 };
@@ -27,7 +27,7 @@
 #include "Separator_p.h"
 #include "FrameworkWidgetFactory.h"
 
-#include <QRubberBand>
+#include <QRegion>
 #include <QApplication>
 #include <QDebug>
 
@@ -45,18 +45,25 @@ Anchor::Anchor(Qt::Orientation orientation, MultiSplitterLayout *multiSplitter,
     , m_orientation(orientation)
     , m_type(type)
     , m_layout(multiSplitter)
-    , m_separatorWidget(Config::self().frameworkWidgetFactory()->createSeparator(this, multiSplitter->multiSplitter()))
+    , m_separatorWidget((Config::self().flags() & Config::Flag_LightweightSeparators) ? nullptr
+                                                                                          : Config::self().frameworkWidgetFactory()->createSeparator(this, multiSplitter->multiSplitter()))
+    , m_thickness(thickness(isStatic()))
     , m_lazyResize(Config::self().flags() & Config::Flag_LazyResize)
-    , m_lazyResizeRubberBand(m_lazyResize ? new QRubberBand(QRubberBand::Line, multiSplitter->multiSplitter()) : nullptr)
 {
     multiSplitter->insertAnchor(this);
-    connect(this, &QObject::objectNameChanged, m_separatorWidget, &QObject::setObjectName);
+    if (m_separatorWidget)
+        connect(this, &QObject::objectNameChanged, m_separatorWidget, &QObject::setObjectName);
 }
 
 Anchor::~Anchor()
 {
-    m_separatorWidget->setEnabled(false);
-    m_separatorWidget->deleteLater();
+    if (m_separatorWidget) {
+        m_separatorWidget->setEnabled(false);
+        m_separatorWidget->deleteLater();
+    } else {
+        updateLightweightSeparator(m_geometry);
+    }
+
     qCDebug(multisplittercreation) << "~Anchor; this=" << this << "; m_to=" << m_to << "; m_from=" << m_from;
     m_layout->removeAnchor(this);
     for (Item *item : items(Side1))
@@ -121,8 +128,13 @@ void Anchor::setGeometry(QRect r)
             qCDebug(anchors) << Q_FUNC_INFO << "Old position was negative" << position() << "; new=" << r;
         }
 
+        const QRect oldGeometry = m_geometry;
         m_geometry = r;
-        m_separatorWidget->setGeometry(r);
+        m_layout->invalidateSerializeCache();
+        if (m_separatorWidget)
+            m_separatorWidget->setGeometry(r);
+        else
+            updateLightweightSeparator(oldGeometry);
     }
 }
 
@@ -200,8 +212,9 @@ Qt::Orientation Anchor::orientation() const
 
 void Anchor::setPosition(int p, SetPositionOptions options)
 {
+    LayoutStatsScope stats(m_layout->m_stats, LayoutStats::Operation_AnchorSetPosition);
     qCDebug(anchors) << Q_FUNC_INFO << this << "; visible="
-                     << m_separatorWidget->isVisible() << "; p=" << p;
+                     << isVisible() << "; p=" << p;
 
     const int max = m_layout->length(orientation()) - Anchor::thickness(true);
     const bool outOfBounds = max != -1 && (p < 0  || p > max);
@@ -227,6 +240,7 @@ void Anchor::setPosition(int p, SetPositionOptions options)
         return;
     }
 
+    const QRect oldGeometry = m_geometry;
     if (isVertical()) {
         m_geometry.moveLeft(p);
     } else {
@@ -239,7 +253,11 @@ void Anchor::setPosition(int p, SetPositionOptions options)
      */
     const bool recalculatePercentage = !(options & SetPositionOption_DontRecalculatePercentage) && !m_layout->isResizing();
 
-    m_separatorWidget->move(p);
+    if (m_separatorWidget)
+        m_separatorWidget->move(p);
+    else
+        updateLightweightSeparator(oldGeometry);
+
     if (recalculatePercentage) {
         // We keep the percentage, so we don't constantly recalculate it during a resize, which introduces rounding errors
         updatePositionPercentage();
@@ -257,6 +275,7 @@ void Anchor::updatePositionPercentage()
 {
     const int layoutLength = m_layout->length(m_orientation);
     m_positionPercentage = (position() * 1.0) / layoutLength;
+    m_layout->invalidateSerializeCache();
 
     if (position() > layoutLength) {
         // This warning makes the unit-tests fail if some invalid m_positionPercentage ever appears.
@@ -274,12 +293,28 @@ int Anchor::position() const
 
 void Anchor::setVisible(bool v)
 {
+    if (!m_separatorWidget) {
+        if (m_visible != v) {
+            m_visible = v;
+            updateLightweightSeparator(m_geometry);
+        }
+        return;
+    }
+
     m_separatorWidget->setVisible(v);
     if (v) {
         m_separatorWidget->setGeometry(m_geometry);
     }
 }
 
+bool Anchor::isVisible() const
+{
+    if (m_separatorWidget)
+        return m_separatorWidget->isVisible();
+
+    return m_visible && m_layout->multiSplitter()->isVisible();
+}
+
 int Anchor::minPosition() const
 {
     const int smallestSqueeze = smallestAvailableItemSqueeze(Side1);
@@ -336,8 +371,7 @@ bool Anchor::isValid() const
 
 int Anchor::thickness() const
 {
-    return isVertical() ? m_separatorWidget->width()
-                        : m_separatorWidget->height();
+    return m_thickness;
 }
 
 bool Anchor::hasItems(Anchor::Side side) const
@@ -504,52 +538,7 @@ bool Anchor::isBeingDragged() const
 
 int Anchor::cumulativeMinLength(Anchor::Side side) const
 {
-    if (isStatic() && isEmpty()) {
-        // There's no widget, but minimum is the space occupied by left+right anchors (or top+bottom).
-        const int staticAnchorThickness = Anchor::thickness(/*static=*/true);
-        if ((side == Side2 && (m_type & (Type_LeftStatic | Type_TopStatic))) ||
-            (side == Side1 && (m_type & (Type_RightStatic | Type_BottomStatic))))
-            return 2 * staticAnchorThickness;
-    }
-    const CumulativeMin result = cumulativeMinLength_recursive(side);
-
-    const int numNonStaticAnchors = result.numItems >= 2 ? result.numItems - 1
-                                                         : 0;
-
-    int r = Anchor::thickness(isStatic()) + Anchor::thickness(true)
-            + numNonStaticAnchors*Anchor::thickness(false)
-            + result.minLength;
-
-    return r;
-}
-
-Anchor::CumulativeMin Anchor::cumulativeMinLength_recursive(Anchor::Side side) const
-{
-    const auto items = this->items(side);
-    CumulativeMin result = { 0, 0 };
-
-    for (auto item : items) {
-        Anchor *oppositeAnchor = item->anchorAtSide(side, orientation());
-        if (!oppositeAnchor) {
-            // Shouldn't happen. But don't assert as this might be being called from a dumpDebug()
-            qWarning() << Q_FUNC_INFO << "Null opposite anchor";
-            return {0, 0};
-        }
-
-        CumulativeMin candidateMin = { 0, 0 };
-        if (!item->isPlaceholder()) {
-            candidateMin.numItems++;
-            candidateMin.minLength = item->minLength(orientation());
-        }
-
-        candidateMin += oppositeAnchor->cumulativeMinLength_recursive(side);
-
-        if (candidateMin.minLength >= result.minLength) {
-            result = candidateMin;
-        }
-    }
-
-    return result;
+    return m_layout->cumulativeMinLength(const_cast<Anchor *>(this), side);
 }
 
 void Anchor::setFollowee(Anchor *followee)
@@ -655,6 +644,7 @@ void Anchor::clear()
 {
     m_side1Items.clear();
     m_side2Items.clear();
+    m_layout->invalidateCumulativeMinLengthCache();
 }
 
 void Anchor::onFolloweePositionChanged(int pos)
@@ -670,10 +660,16 @@ int Anchor::thickness(bool staticAnchor)
 
 void Anchor::setLayout(MultiSplitterLayout *layout)
 {
+    if (!m_separatorWidget)
+        updateLightweightSeparator(m_geometry); // So the old MultiSplitter stops painting us
+
     m_layout->removeAnchor(this);
     m_layout = layout;
     setParent(layout->multiSplitter());
-    m_separatorWidget->setParent(layout->multiSplitter());
+    if (m_separatorWidget)
+        m_separatorWidget->setParent(layout->multiSplitter());
+    else
+        updateLightweightSeparator(m_geometry);
     m_layout->insertAnchor(this);
     m_layout->setAnchorBeingDragged(nullptr);
 }
@@ -691,32 +687,40 @@ void Anchor::setThickness()
     const int oldValue = thickness();
 
     if (value != oldValue) {
+        const QRect oldGeometry = m_geometry;
+        m_thickness = value;
         if (isVertical()) {
-            m_separatorWidget->setFixedWidth(value);
+            if (m_separatorWidget)
+                m_separatorWidget->setFixedWidth(value);
             m_geometry.setWidth(value);
         } else {
-            m_separatorWidget->setFixedHeight(value);
+            if (m_separatorWidget)
+                m_separatorWidget->setFixedHeight(value);
             m_geometry.setHeight(value);
         }
 
+        if (!m_separatorWidget)
+            updateLightweightSeparator(oldGeometry);
+
         Q_EMIT thicknessChanged();
     }
 }
 
-void Anchor::setLazyPosition(int pos)
+void Anchor::updateLightweightSeparator(QRect oldGeometry)
 {
-    if (m_lazyPosition != pos) {
-        m_lazyPosition = pos;
-
-        QRect geo = m_separatorWidget->geometry();
-        if (isVertical()) {
-            geo.moveLeft(pos);
-        } else {
-            geo.moveTop(pos);
-        }
+    // Without a separator widget the MultiSplitter paints us, schedule a repaint of what changed
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    m_layout->multiSplitter()->update(QRegion(oldGeometry).united(m_geometry));
+#else
+    Q_UNUSED(oldGeometry);
+    m_layout->multiSplitter()->update();
+#endif
+}
 
-        m_lazyResizeRubberBand->setGeometry(geo);
-    }
+void Anchor::setLazyPosition(int pos)
+{
+    m_lazyPosition = pos;
+    m_layout->showLazyResizePreview(this, pos);
 }
 
 int Anchor::position(QPoint p) const
@@ -731,6 +735,7 @@ void Anchor::addItem(Item *item, Anchor::Side side)
     if (!items.contains(item)) {
         items << item;
         item->anchorGroup().setAnchor(this, orientation(), side);
+        m_layout->invalidateCumulativeMinLengthCache();
         Q_EMIT itemsChanged(side);
         updateItemSizes();
     }
@@ -746,10 +751,12 @@ void Anchor::removeItem(Item *item)
 {
     if (m_side1Items.removeOne(item)) {
         item->anchorGroup().setAnchor(nullptr, orientation(), Side1);
+        m_layout->invalidateCumulativeMinLengthCache();
         Q_EMIT itemsChanged(Side1);
     } else {
         if (m_side2Items.removeOne(item)) {
             item->anchorGroup().setAnchor(nullptr, orientation(), Side2);
+            m_layout->invalidateCumulativeMinLengthCache();
             Q_EMIT itemsChanged(Side2);
         }
     }
@@ -781,16 +788,16 @@ void Anchor::onMousePress()
     m_layout->setAnchorBeingDragged(this);
     qCDebug(anchors) << "Drag started";
 
-    if (m_lazyResize) {
+    if (m_lazyResize)
         setLazyPosition(position());
-        m_lazyResizeRubberBand->show();
-    }
 }
 
 void Anchor::onMouseReleased()
 {
     if (m_lazyResize) {
-        m_lazyResizeRubberBand->hide();
+        m_layout->hideLazyResizePreview();
+        // Frames are only resized once, even if followers move too
+        MultiSplitterLayout::GeometryTransaction transaction(m_layout);
         setPosition(m_lazyPosition);
     }
 
@@ -831,10 +838,10 @@ void Anchor::onMouseMoved(QPoint pt)
                                                       : (positionToGoTo > position() ? Side2
                                                                                      : Side_None); // Side_None shouldn't happen though.
 
-    if (m_lazyResize)
-        setLazyPosition(positionToGoTo);
-    else
+    if (!m_lazyResize)
         setPosition(positionToGoTo);
+    else if (positionToGoTo != m_lazyPosition)
+        setLazyPosition(positionToGoTo);
 }
 
 void Anchor::onWidgetMoved(int p)
@@ -882,6 +889,13 @@ Anchor *Anchor::deserialize(const LayoutSaver::Anchor &a, MultiSplitterLayout *l
     return anchor;
 }
 
+void Anchor::restoreGeometry(const LayoutSaver::Anchor &a)
+{
+    setGeometry(a.geometry);
+    m_positionPercentage = a.positionPercentage;
+    m_layout->invalidateSerializeCache();
+}
+
 LayoutSaver::Anchor Anchor::serialize() const
 {
     LayoutSaver::Anchor a;
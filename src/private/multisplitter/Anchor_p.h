@@ -29,10 +29,6 @@
 #include <QRect>
 #include <QVector>
 
-QT_BEGIN_NAMESPACE
-class QRubberBand;
-QT_END_NAMESPACE
-
 namespace KDDockWidgets {
 
 class Item;
@@ -131,6 +127,9 @@ public:
     static Anchor* deserialize(const LayoutSaver::Anchor &, MultiSplitterLayout *layout);
     LayoutSaver::Anchor serialize() const;
 
+    ///@brief Applies the saved geometry to an existing anchor. Just for LayoutSaver::restore, see MultiSplitterLayout::deserializeInPlace()
+    void restoreGeometry(const LayoutSaver::Anchor &);
+
     void setFrom(Anchor *);
     Anchor *from() const { return m_from; }
     Anchor *to() const { return m_to; }
@@ -146,6 +145,13 @@ public:
     int position() const;
 
     void setVisible(bool);
+
+    /**
+     * @brief Returns whether this separator is visible.
+     * Works with and without Config::Flag_LightweightSeparators.
+     */
+    bool isVisible() const;
+
     qreal positionPercentage() const { return m_positionPercentage; }
 
     void ensureBounded();
@@ -157,6 +163,7 @@ public:
     void setLayout(MultiSplitterLayout *);
 
     ///@brief returns the separator widget
+    ///Returns nullptr if Config::Flag_LightweightSeparators is set, as the MultiSplitter paints the separators itself then.
     Separator* separatorWidget() const;
 
     /**
@@ -227,6 +234,10 @@ public:
 
     Type type() const { return m_type; }
 
+    /**
+     * @brief Returns the length needed between this anchor and the static anchor at side @p side.
+     * See LayoutMath::cumulativeMinLength(). Memoized by the layout.
+     */
     int cumulativeMinLength(Anchor::Side side) const;
 
     /**
@@ -285,19 +296,9 @@ public:
     static bool isResizing();
 
 private:
-    struct CumulativeMin {
-        int minLength;
-        int numItems;
-        CumulativeMin& operator+=(CumulativeMin other) {
-            minLength += other.minLength;
-            numItems += other.numItems;
-            return *this;
-        }
-    };
-    CumulativeMin cumulativeMinLength_recursive(Anchor::Side side) const;
-
     void setThickness();
     void setLazyPosition(int);
+    void updateLightweightSeparator(QRect oldGeometry);
 
 Q_SIGNALS:
     void positionChanged(int pos);
@@ -343,11 +344,12 @@ public:
     QString m_debug_side2ItemNames;
     Separator *const m_separatorWidget;
     QRect m_geometry;
+    int m_thickness;
+    bool m_visible = true; // Only used when there's no separator widget
     Anchor *m_followee = nullptr;
     QMetaObject::Connection m_followeeDestroyedConnection;
     const bool m_lazyResize;
     int m_lazyPosition = 0;
-    QRubberBand *const m_lazyResizeRubberBand;
 };
 
 }
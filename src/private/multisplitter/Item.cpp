@@ -28,11 +28,12 @@
 #include "Config.h"
 #include "FrameworkWidgetFactory.h"
 
-#include <qmath.h>
 #include <QEvent>
 
 using namespace KDDockWidgets;
 
+static quint64 s_placeholderSerial = 0;
+
 class Item::Private {
 public:
 
@@ -67,6 +68,10 @@ public:
 
     void updateObjectName();
     void setMinimumSize(QSize);
+
+    ///@brief Sets the frame's geometry, accounting it in the layout's stats
+    void setFrameGeometry(QRect geometry);
+
     Item *const q;
     AnchorGroup m_anchorGroup;
     Frame *m_frame = nullptr;
@@ -76,10 +81,16 @@ public:
     QSize m_minSize;
     bool m_destroying = false;
     int m_refCount = 0;
+    QVector<LastPosition*> m_lastPositions;
+    quint64 m_placeholderSerial = 0;
     bool m_blockPropagateGeo = false;
+    bool m_geometryPending = false; // true while in a geometry transaction and m_frame wasn't updated yet
+    QRect m_geometryBeforeTransaction;
     QMetaObject::Connection m_onFrameLayoutRequest_connection;
     QMetaObject::Connection m_onFrameDestroyed_connection;
     QMetaObject::Connection m_onFrameObjectNameChanged_connection;
+    QMetaObject::Connection m_onFrameDockWidgetsChanged_connection;
+    QMetaObject::Connection m_onFrameCurrentDockWidgetChanged_connection;
 };
 
 Item::Item(Frame *frame, MultiSplitterLayout *parent)
@@ -174,11 +185,24 @@ void Item::setGeometry(QRect geo)
                  << "; minLen=" << minLength(geoDiff.orientation())
                  << "; window=" << parentWidget()->window()
                  << "this=" << this;*/
-        d->m_geometry = geo;
-        Q_EMIT geometryChanged();
+        if (d->m_layout)
+            d->m_layout->invalidateHitTestIndex();
+
+        if (d->m_layout && d->m_layout->isInGeometryTransaction()) {
+            // Frame geometry and geometryChanged() are deferred to commitGeometryTransaction()
+            if (!d->m_geometryPending) {
+                d->m_geometryPending = true;
+                d->m_geometryBeforeTransaction = d->m_geometry;
+                d->m_layout->scheduleGeometryUpdate(this);
+            }
+            d->m_geometry = geo;
+        } else {
+            d->m_geometry = geo;
+            Q_EMIT geometryChanged();
 
-        if (!isPlaceholder())
-            d->m_frame->setGeometry(geo);
+            if (!isPlaceholder())
+                d->setFrameGeometry(geo);
+        }
 
         if (!d->m_blockPropagateGeo && d->m_anchorGroup.isValid() && geoDiff.onlyOneSideChanged) {
             // If we're being squeezed to the point where it reaches less then our min size, then we drag the opposite separator, to preserve size
@@ -190,67 +214,29 @@ void Item::setGeometry(QRect geo)
     }
 }
 
-void Item::ensureMinSize(Qt::Orientation orientation, Anchor::Side side)
+void Item::applyPendingGeometry()
 {
-    if (isPlaceholder())
-        return;
-
-    const int delta = length(orientation) - minLength(orientation);
-    if (delta >= 0) // Our size is just fine
+    if (!d->m_geometryPending)
         return;
 
-    Anchor *anchorToMove = d->m_anchorGroup.anchorAtSide(side, orientation);
-    if (anchorToMove->isFollowing())
-        anchorToMove = anchorToMove->endFollowee();
+    d->m_geometryPending = false;
 
-    const bool movingSide1 = side == Anchor::Side1; // if true we're going to move left or top.
-    const int signess = movingSide1 ? 1 : -1;
-    const int newPosition = anchorToMove->position() + (delta * signess);
+    if (d->m_frame && !isPlaceholder() && d->m_frame->geometry() != d->m_geometry)
+        d->setFrameGeometry(d->m_geometry);
 
-    // Note: Position can be slightly negative if the main window isn't big enougn to host the new size.
-    // In that case the window will be resized shortly after
-    Q_ASSERT(!anchorToMove->isFollowing());
-
-    // When dropping a MultiSplitter into a MultiSplitter there's an instant where some anchors of the group are from the source MultiSplitter, as they weren't consumed yet.
-    if (anchorToMove->parent() == parentWidget())
-        anchorToMove->setPosition(newPosition);
+    if (d->m_geometryBeforeTransaction != d->m_geometry)
+        Q_EMIT geometryChanged();
+}
 
+void Item::ensureMinSize(Qt::Orientation orientation, Anchor::Side side)
+{
     // Anchor::setPosition() will call Item::ensureMinSize_recursive() again on the next items
+    d->m_layout->ensureMinSize(this, orientation, side);
 }
 
 void Item::ensureMinSize(Qt::Orientation orientation)
 {
-    if (isPlaceholder())
-        return;
-
-    const int minLength = this->minLength(orientation);
-    const int delta = length(orientation) - minLength;
-    if (delta >= 0) // Our size is just fine
-        return;
-
-    const int newLength = minLength;
-
-    Anchor *anchor1 = anchorGroup().anchorAtSide(Anchor::Side1, orientation);
-    Anchor *anchor2 = anchorGroup().anchorAtSide(Anchor::Side2, orientation);
-
-    anchor1 = anchor1->isFollowing() ? anchor1->endFollowee() : anchor1;
-    anchor2 = anchor2->isFollowing() ? anchor2->endFollowee() : anchor2;
-
-    const int bound1 = d->m_layout->boundPositionForAnchor(anchor1, Anchor::Side1);
-    const int bound2 = d->m_layout->boundPositionForAnchor(anchor2, Anchor::Side2);
-
-    // If vertical, anchor1 is the left separator and anchor2 is the right one. We'll push anchor1
-    // further left and anchor2 further right.
-
-    const int suggestedDelta1 = qMin(delta, qCeil(delta / 2) + anchor1->thickness() + 1);
-    const int maxPos1 = bound2 - newLength - anchor1->thickness();
-    const int newPosition1 = qMin(anchor1->position(), qMax(qMin(maxPos1, anchor1->position() - suggestedDelta1), bound1)); // Honour the bound
-    const int newPosition2 = newPosition1 + anchor1->thickness() + newLength; // No need to check bound2, we have enough space afterall
-
-    if (!anchor1->isStatic())
-        anchor1->setPosition(newPosition1);
-    if (!anchor2->isStatic())
-        anchor2->setPosition(newPosition2);
+    d->m_layout->ensureMinSize(this, orientation);
 }
 
 void Item::beginBlockPropagateGeo()
@@ -405,7 +391,7 @@ void Item::restorePlaceholder(DockWidgetBase *dockWidget, int tabIndex)
     qCDebug(placeholder) << Q_FUNC_INFO << "Restoring to window=" << window();
     if (d->m_isPlaceholder) {
         d->setFrame(Config::self().frameworkWidgetFactory()->createFrame(layout()->multiSplitter()));
-        d->m_frame->setGeometry(d->m_geometry);
+        d->setFrameGeometry(d->m_geometry);
     }
 
     if (tabIndex != -1 && d->m_frame->dockWidgetCount() >= tabIndex) {
@@ -429,7 +415,7 @@ void Item::restorePlaceholder(Frame *frame)
 
     frame->setParent(layout()->multiSplitter());
     d->setFrame(frame);
-    d->m_frame->setGeometry(d->m_geometry);
+    d->setFrameGeometry(d->m_geometry);
     d->m_layout->restorePlaceholder(this);
     d->m_frame->setVisible(true);
     d->setIsPlaceholder(false);
@@ -446,7 +432,7 @@ void Item::onLayoutRequest() const
     if (d->m_frame->geometry() != geometry()) {
         // The frame is controlled by the layout, it can't change its geometry on its own.
         // Put it back.
-        d->m_frame->setGeometry(geometry());
+        d->setFrameGeometry(geometry());
     }
 
     if (d->m_layout->isAddingItem())
@@ -487,10 +473,30 @@ void Item::onLayoutRequest() const
     }
 }
 
+void Item::Private::setFrameGeometry(QRect geometry)
+{
+    if (!m_layout) {
+        m_frame->setGeometry(geometry);
+        return;
+    }
+
+    LayoutStatsScope stats(m_layout->m_stats, LayoutStats::Operation_FrameGeometryUpdate);
+    m_frame->setGeometry(geometry);
+}
+
 void Item::Private::setMinimumSize(QSize sz)
 {
     if (sz != m_minSize) {
+        // Only the anchor chains of the orientation that changed are affected
+        Qt::Orientations changedOrientations;
+        if (sz.width() != m_minSize.width())
+            changedOrientations |= Qt::Vertical;
+        if (sz.height() != m_minSize.height())
+            changedOrientations |= Qt::Horizontal;
+
         m_minSize = sz;
+        if (m_layout)
+            m_layout->invalidateCumulativeMinLengthCache(q, changedOrientations);
         Q_EMIT q->minimumSizeChanged();
     }
 }
@@ -498,9 +504,11 @@ void Item::Private::setMinimumSize(QSize sz)
 void Item::restoreSizes(QSize minSize, QRect geometry)
 {
     d->m_minSize = minSize;
+    if (d->m_layout)
+        d->m_layout->invalidateCumulativeMinLengthCache();
     d->m_geometry = geometry;
     if (d->m_frame)
-        d->m_frame->setGeometry(geometry);
+        d->setFrameGeometry(geometry);
 }
 
 void Item::Private::setFrame(Frame *frame)
@@ -512,9 +520,13 @@ void Item::Private::setFrame(Frame *frame)
         QObject::disconnect(m_onFrameDestroyed_connection);
         QObject::disconnect(m_onFrameLayoutRequest_connection);
         QObject::disconnect(m_onFrameObjectNameChanged_connection);
+        QObject::disconnect(m_onFrameDockWidgetsChanged_connection);
+        QObject::disconnect(m_onFrameCurrentDockWidgetChanged_connection);
     }
 
     m_frame = frame;
+    if (m_layout)
+        m_layout->invalidateSerializeCache();
     Q_EMIT q->frameChanged();
 
     if (frame) {
@@ -545,23 +557,36 @@ void Item::Private::setFrame(Frame *frame)
 
         m_onFrameLayoutRequest_connection = connect(frame, &Frame::layoutInvalidated, q, &Item::onLayoutRequest);
         m_onFrameObjectNameChanged_connection = connect(frame, &QObject::objectNameChanged, q, [this] { updateObjectName(); });
+
+        // The frame's tabs are saved with the layout
+        auto invalidateSerializeCache = [this] {
+            if (m_layout)
+                m_layout->invalidateSerializeCache();
+        };
+        m_onFrameDockWidgetsChanged_connection = connect(frame, &Frame::numDockWidgetsChanged, q, invalidateSerializeCache);
+        m_onFrameCurrentDockWidgetChanged_connection = connect(frame, &Frame::currentDockWidgetChanged, q, invalidateSerializeCache);
         updateObjectName();
     }
 }
 
-void Item::ref()
+void Item::ref(LastPosition *lastPosition)
 {
+    if (lastPosition)
+        d->m_lastPositions.push_back(lastPosition);
     d->m_refCount++;
     qCDebug(placeholder()) << Q_FUNC_INFO << "; new ref=" << d->m_refCount;
 }
 
-void Item::unref()
+void Item::unref(LastPosition *lastPosition)
 {
     if (d->m_refCount == 0) {
         qWarning() << Q_FUNC_INFO << "refcount can't be 0";
         return;
     }
 
+    if (lastPosition)
+        d->m_lastPositions.removeOne(lastPosition);
+
     d->m_refCount--;
     qCDebug(placeholder()) << Q_FUNC_INFO << "; new ref=" << d->m_refCount;
 
@@ -578,6 +603,16 @@ int Item::refCount() const
     return d->m_refCount;
 }
 
+QVector<LastPosition*> Item::lastPositions() const
+{
+    return d->m_lastPositions;
+}
+
+quint64 Item::placeholderSerial() const
+{
+    return d->m_placeholderSerial;
+}
+
 void Item::Private::turnIntoPlaceholder()
 {
     qCDebug(placeholder) << Q_FUNC_INFO << this;
@@ -605,12 +640,22 @@ void Item::Private::setIsPlaceholder(bool is)
 {
     if (is != m_isPlaceholder) {
         m_isPlaceholder = is;
+        if (is)
+            m_placeholderSerial = ++s_placeholderSerial;
+        if (m_layout) {
+            m_layout->invalidateCumulativeMinLengthCache(q);
+            if (is)
+                m_layout->scheduleCompactPlaceholders();
+        }
         Q_EMIT q->isPlaceholderChanged();
     }
 }
 
 void Item::Private::updateObjectName()
 {
+    if (m_layout)
+        m_layout->invalidateSerializeCache();
+
     if (m_frame && !m_frame->objectName().isEmpty()) {
         q->setObjectName(m_frame->objectName());
     } else if (q->isPlaceholder()) {
@@ -39,6 +39,7 @@ struct AnchorGroup;
 class MultiSplitterLayout;
 class Frame;
 class DockWidgetBase;
+class LastPosition;
 class TestDocks;
 
 struct GeometryDiff
@@ -172,9 +173,17 @@ public:
      */
     void onLayoutRequest() const;
 
-    void ref();
-    void unref();
+    ///@brief Refs the item. @p lastPosition is the dock widget position holding the ref, if any
+    void ref(LastPosition *lastPosition = nullptr);
+    void unref(LastPosition *lastPosition = nullptr);
     int refCount() const; // for tests
+
+    ///@brief The LastPositions that ref this item, so a placeholder can be released without
+    /// going through every dock widget
+    QVector<LastPosition*> lastPositions() const;
+
+    ///@brief Increases every time an Item turns into a placeholder, so lower means least recently used
+    quint64 placeholderSerial() const;
 Q_SIGNALS:
     void frameChanged();
     void geometryChanged();
@@ -182,6 +191,8 @@ Q_SIGNALS:
     void minimumSizeChanged();
 private:
     friend KDDockWidgets::TestDocks;
+    friend class MultiSplitterLayout;
+    void applyPendingGeometry(); // Called by MultiSplitterLayout::commitGeometryTransaction()
     QSize actualMinSize() const; // The min size, regardless if it's a placeholder or not, so we can save the actual value while LayoutSaver::saveLayout
     void restoreSizes(QSize minSize, QRect geometry); // Just for LayoutSaver::restore
 
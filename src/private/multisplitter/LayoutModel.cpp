@@ -0,0 +1,930 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LayoutModel_p.h"
+
+#include <QDebug>
+
+#include <tuple>
+
+using namespace KDDockWidgets;
+
+static int lengthFromSize(QSize sz, Qt::Orientation orientation)
+{
+    return orientation == Qt::Vertical ? sz.width() : sz.height();
+}
+
+static Qt::Orientation anchorOrientationForLocation(Location l)
+{
+    return (l == Location_OnLeft || l == Location_OnRight) ? Qt::Vertical
+                                                           : Qt::Horizontal;
+}
+
+static AnchorData::Side oppositeSide(AnchorData::Side side)
+{
+    return side == AnchorData::Side1 ? AnchorData::Side2 : AnchorData::Side1;
+}
+
+// Same as AnchorGroup::anchor()
+static int anchorForLocation(const ItemData &group, Location location)
+{
+    switch (location) {
+    case Location_OnLeft:
+        return group.leftAnchor;
+    case Location_OnTop:
+        return group.topAnchor;
+    case Location_OnRight:
+        return group.rightAnchor;
+    default:
+        return group.bottomAnchor;
+    }
+}
+
+// Same as AnchorGroup::setAnchor()
+static void setAnchorForLocation(ItemData &group, Location location, int anchor)
+{
+    switch (location) {
+    case Location_OnLeft:
+        group.leftAnchor = anchor;
+        break;
+    case Location_OnTop:
+        group.topAnchor = anchor;
+        break;
+    case Location_OnRight:
+        group.rightAnchor = anchor;
+        break;
+    default:
+        group.bottomAnchor = anchor;
+        break;
+    }
+}
+
+int ItemData::anchorAtSide(AnchorData::Side side, Qt::Orientation orientation) const
+{
+    const bool isSide1 = side == AnchorData::Side1;
+    if (orientation == Qt::Vertical)
+        return isSide1 ? leftAnchor : rightAnchor;
+
+    return isSide1 ? topAnchor : bottomAnchor;
+}
+
+int &ItemData::anchorAtSide(AnchorData::Side side, Qt::Orientation orientation)
+{
+    const bool isSide1 = side == AnchorData::Side1;
+    if (orientation == Qt::Vertical)
+        return isSide1 ? leftAnchor : rightAnchor;
+
+    return isSide1 ? topAnchor : bottomAnchor;
+}
+
+/// LayoutMath's view of a LayoutModel
+struct LayoutSolver::Graph
+{
+    typedef int AnchorRef;
+    typedef int ItemRef;
+
+    explicit Graph(const LayoutSolver *solver)
+        : q(solver)
+    {
+    }
+
+    const AnchorData &anchor(int index) const { return q->m_model.anchors.at(index); }
+    const ItemData &item(int index) const { return q->m_model.items.at(index); }
+
+    bool isValid(int a) const { return a != -1; }
+    Qt::Orientation orientation(int a) const { return anchor(a).orientation; }
+    QVector<int> items(int a, AnchorData::Side side) const { return anchor(a).items(side); }
+    int anchorAtSide(int i, AnchorData::Side side, Qt::Orientation o) const { return item(i).anchorAtSide(side, o); }
+    bool isPlaceholder(int i) const { return item(i).isPlaceholder; }
+    int minLength(int i, Qt::Orientation o) const { return lengthFromSize(item(i).minimumSize(), o); }
+    int itemLength(int i, Qt::Orientation o) const { return lengthFromSize(item(i).geometry.size(), o); }
+    bool isStatic(int a) const { return anchor(a).isStatic(); }
+    bool isEmpty(int a) const { return anchor(a).side1Items.isEmpty() && anchor(a).side2Items.isEmpty(); }
+    bool isLeftOrTopStatic(int a) const { return a == q->m_model.leftAnchor || a == q->m_model.topAnchor; }
+    bool isRightOrBottomStatic(int a) const { return a == q->m_model.rightAnchor || a == q->m_model.bottomAnchor; }
+    bool isFollowing(int a) const { return anchor(a).isFollowing(); }
+    int endFollowee(int a) const { return q->endFollowee(a); }
+    int staticAnchorThickness() const { return q->m_model.staticAnchorThickness; }
+    int anchorThickness() const { return q->m_model.anchorThickness; }
+    int defaultThickness(int a) const { return isStatic(a) ? staticAnchorThickness() : anchorThickness(); }
+    int thickness(int a) const { return anchor(a).thickness; }
+    int position(int a) const { return anchor(a).position; }
+    int length(Qt::Orientation o) const { return q->length(o); }
+    bool hasNonPlaceholderItems(int a, AnchorData::Side side) const { return q->hasNonPlaceholderItems(a, side); }
+    int minPosition(int a) const { return q->minPosition(a); }
+    qreal positionPercentage(int a) const { return anchor(a).positionPercentage; }
+
+    bool cachedCumulativeMinLength(int a, AnchorData::Side side, CumulativeMin &result) const
+    {
+        // Min lengths don't depend on positions, only topology changes clear this cache
+        auto it = q->m_cumulativeMinLengthCache.constFind(qMakePair(a, int(side)));
+        if (it == q->m_cumulativeMinLengthCache.cend())
+            return false;
+
+        result = *it;
+        return true;
+    }
+
+    void cacheCumulativeMinLength(int a, AnchorData::Side side, CumulativeMin result) const
+    {
+        q->m_cumulativeMinLengthCache.insert(qMakePair(a, int(side)), result);
+    }
+
+    const LayoutSolver *const q;
+};
+
+LayoutSolver::LayoutSolver(const LayoutModel &model)
+    : m_model(model)
+{
+    detach();
+}
+
+int LayoutSolver::cumulativeMinLength(int anchor, AnchorData::Side side) const
+{
+    return LayoutMath<Graph>::cumulativeMinLength(Graph(this), anchor, side);
+}
+
+QSize LayoutSolver::minimumSize() const
+{
+    return QSize(cumulativeMinLength(m_model.leftAnchor, AnchorData::Side2),
+                 cumulativeMinLength(m_model.topAnchor, AnchorData::Side2));
+}
+
+QPair<int, int> LayoutSolver::boundPositions(int anchor) const
+{
+    return LayoutMath<Graph>::boundPositions(Graph(this), anchor);
+}
+
+bool LayoutSolver::moveAnchor(int anchor, int position)
+{
+    detach();
+    const AnchorData &a = m_model.anchors.at(anchor);
+    if (a.isStatic() || a.isFollowing())
+        return false;
+
+    const QPair<int, int> bounds = boundPositions(anchor);
+    if (position < bounds.first || position > bounds.second)
+        return false;
+
+    setAnchorPosition(anchor, position);
+    return true;
+}
+
+bool LayoutSolver::resize(QSize size)
+{
+    detach();
+    const QSize minSize = minimumSize();
+    if (size.width() < minSize.width() || size.height() < minSize.height())
+        return false;
+
+    const QSize oldSize = m_model.size;
+    if (size == oldSize)
+        return true;
+
+    m_model.size = size;
+    m_resizing = true;
+    positionStaticAnchors();
+
+    auto setPosition = [this] (int anchor, int position) {
+        setAnchorPosition(anchor, position, /*dontRecalculatePercentage=*/ true);
+    };
+
+    if (oldSize.width() != size.width())
+        LayoutMath<Graph>::redistributeSpace_recursive(Graph(this), m_model.leftAnchor, 0, setPosition);
+    if (oldSize.height() != size.height())
+        LayoutMath<Graph>::redistributeSpace_recursive(Graph(this), m_model.topAnchor, 0, setPosition);
+
+    m_resizing = false;
+    ensureAnchorsBounded();
+
+    return true;
+}
+
+int LayoutSolver::addItem(QSize minSize, QSize preferredSize, Location location, int relativeTo)
+{
+    if (location == Location_None) {
+        qWarning() << Q_FUNC_INFO << "Location can't be none";
+        return -1;
+    }
+
+    if (relativeTo < -1 || relativeTo >= m_model.items.size() || (relativeTo != -1 && m_model.items.at(relativeTo).isPlaceholder)) {
+        qWarning() << Q_FUNC_INFO << "Invalid relativeTo" << relativeTo;
+        return -1;
+    }
+
+    detach();
+
+    ensureEnoughSize(minSize, preferredSize, location, relativeTo);
+
+    const bool isEmpty = m_model.items.isEmpty();
+    const int staticAnchorThickness = m_model.staticAnchorThickness;
+    const QRect relativeToRect = relativeTo == -1 ? QRect(QPoint(0, 0), m_model.size).adjusted(staticAnchorThickness, staticAnchorThickness,
+                                                                                               -staticAnchorThickness, -staticAnchorThickness)
+                                                  : m_model.items.at(relativeTo).geometry;
+
+    const DropLength lfd = lengthForDrop(minSize, preferredSize, location, relativeTo);
+    const QRect dropRect = LayoutMath<Graph>::rectForDrop(Graph(this), lfd, location, relativeToRect, !isEmpty);
+    if (lfd.isNull() || dropRect.size().isNull() || dropRect.x() < 0 || dropRect.y() < 0) {
+        qWarning() << Q_FUNC_INFO << "Invalid drop rect" << dropRect
+                   << "; size=" << m_model.size
+                   << "; location=" << location
+                   << "; minSize=" << minSize;
+        return -1;
+    }
+
+    m_addingItem = true;
+
+    // Same as MultiSplitterLayout::createTargetAnchorGroup()
+    ItemData newItem = anchorGroup(relativeTo);
+    newItem.minSize = minSize;
+    int newAnchor = -1;
+    if (relativeTo == -1) {
+        if (!isEmpty) {
+            // The new anchor takes all the items of the static one, like MultiSplitterLayout::newAnchor()
+            const int donor = anchorForLocation(newItem, location);
+            newAnchor = createAnchorFrom(donor, -1, m_model.anchors.at(donor).from, m_model.anchors.at(donor).to);
+            setAnchorForLocation(newItem, oppositeLocation(location), newAnchor);
+            updateAnchorsFromTo(donor, newAnchor);
+        }
+    } else {
+        const int other = anchorForLocation(newItem, location);
+        const bool isVertical = m_model.anchors.at(other).isVertical();
+        newAnchor = createAnchorFrom(other, relativeTo,
+                                     isVertical ? newItem.topAnchor : newItem.leftAnchor,
+                                     isVertical ? newItem.bottomAnchor : newItem.rightAnchor);
+        setAnchorForLocation(newItem, oppositeLocation(location), newAnchor);
+    }
+
+    auto setPosition = [this] (int anchor, int position) {
+        setAnchorPosition(anchor, position);
+    };
+
+    auto propagateResize = [this, &setPosition] (int delta, int fromAnchor, AnchorData::Side direction) {
+        if (delta < 0)
+            qWarning() << "LayoutSolver::addItem: Invalid delta" << delta << fromAnchor << direction;
+
+        if (delta > 0 && !m_model.anchors.at(fromAnchor).isStatic())
+            LayoutMath<Graph>::propagateResize(Graph(this), delta, fromAnchor, direction, setPosition);
+    };
+
+    if (newAnchor != -1 && !m_model.anchors.at(newAnchor).isFollowing()) {
+        const int anchorThickness = m_model.anchorThickness;
+        const int existingAnchor = anchorForLocation(newItem, location);
+        const int existingAnchorThickness = m_model.anchors.at(existingAnchor).thickness;
+
+        int posForExistingAnchor = 0;
+        int posForNewAnchor = 0;
+
+        switch (location) {
+        case Location_OnLeft:
+            posForExistingAnchor = dropRect.left() - existingAnchorThickness;
+            posForNewAnchor = dropRect.right() + 1;
+            break;
+        case Location_OnTop:
+            posForExistingAnchor = dropRect.top() - existingAnchorThickness;
+            posForNewAnchor = dropRect.bottom() + 1;
+            break;
+        case Location_OnBottom:
+            posForExistingAnchor = dropRect.bottom() + 1;
+            posForNewAnchor = dropRect.top() - anchorThickness;
+            break;
+        case Location_OnRight:
+            posForExistingAnchor = dropRect.right() + 1;
+            posForNewAnchor = dropRect.left() - anchorThickness;
+            break;
+        case Location_None:
+            break;
+        }
+
+        int delta1 = 0;
+        int delta2 = 0;
+        int direction1Anchor = -1;
+        int direction2Anchor = -1;
+        const int originalExistingAnchorPos = m_model.anchors.at(existingAnchor).position;
+
+        if (location == Location_OnLeft || location == Location_OnTop) {
+            direction1Anchor = existingAnchor;
+            direction2Anchor = newAnchor;
+            std::tie(posForExistingAnchor, posForNewAnchor) = LayoutMath<Graph>::boundInterval(Graph(this), posForExistingAnchor, existingAnchor,
+                                                                                               posForNewAnchor, newAnchor);
+            delta1 = originalExistingAnchorPos - posForExistingAnchor;
+            delta2 = posForNewAnchor - posForExistingAnchor;
+        } else {
+            direction1Anchor = newAnchor;
+            direction2Anchor = existingAnchor;
+            std::tie(posForNewAnchor, posForExistingAnchor) = LayoutMath<Graph>::boundInterval(Graph(this), posForNewAnchor, newAnchor,
+                                                                                               posForExistingAnchor, existingAnchor);
+            delta1 = posForExistingAnchor - posForNewAnchor;
+            delta2 = posForExistingAnchor - originalExistingAnchorPos;
+        }
+
+        setAnchorPosition(newAnchor, posForNewAnchor);
+
+        if (posForExistingAnchor != originalExistingAnchorPos) {
+            if (m_model.anchors.at(existingAnchor).isStatic()) {
+                qWarning() << Q_FUNC_INFO << "Trying to move static anchor from" << originalExistingAnchorPos
+                           << "to" << posForExistingAnchor << "; location=" << location
+                           << "; dropRect=" << dropRect;
+            }
+            setAnchorPosition(existingAnchor, posForExistingAnchor);
+        }
+
+        // The anchors further away contribute space too, not just the adjacent ones
+        propagateResize(delta1, direction1Anchor, AnchorData::Side1);
+        propagateResize(delta2, direction2Anchor, AnchorData::Side2);
+    }
+
+    if (newAnchor != -1) {
+        // Also ensure the item has its min size in the other orientation
+        const bool newAnchorIsVertical = m_model.anchors.at(newAnchor).isVertical();
+        const int adjacent1 = newAnchorIsVertical ? newItem.topAnchor : newItem.leftAnchor;
+        const int adjacent2 = newAnchorIsVertical ? newItem.bottomAnchor : newItem.rightAnchor;
+        const AnchorData &a1 = m_model.anchors.at(adjacent1);
+        const AnchorData &a2 = m_model.anchors.at(adjacent2);
+
+        const int bound1 = boundPositions(adjacent1).first;
+        const int bound2 = boundPositions(adjacent2).second;
+        const int min = lengthFromSize(minSize, a1.orientation);
+        const int has = a2.position - a1.position - a1.thickness;
+        const int needs = min - has;
+        if (needs > 0) {
+            const int pos1 = qMax(bound1, a1.position - needs);
+            const int pos2 = pos1 + a1.thickness + min;
+            Q_ASSERT(pos2 <= bound2);
+            setAnchorPosition(adjacent1, pos1);
+            setAnchorPosition(adjacent2, pos2);
+        }
+    }
+
+    // Same as AnchorGroup::addItem()
+    const int item = m_model.items.size();
+    const AnchorData &left = m_model.anchors.at(newItem.leftAnchor);
+    const AnchorData &top = m_model.anchors.at(newItem.topAnchor);
+    newItem.geometry = QRect(QPoint(left.position + left.thickness, top.position + top.thickness),
+                             QPoint(m_model.anchors.at(newItem.rightAnchor).position - 1,
+                                    m_model.anchors.at(newItem.bottomAnchor).position - 1));
+    m_model.items.push_back(newItem);
+    m_model.anchors[newItem.leftAnchor].side2Items.push_back(item);
+    m_model.anchors[newItem.topAnchor].side2Items.push_back(item);
+    m_model.anchors[newItem.rightAnchor].side1Items.push_back(item);
+    m_model.anchors[newItem.bottomAnchor].side1Items.push_back(item);
+    m_cumulativeMinLengthCache.clear();
+
+    updateSizeConstraints();
+    updateAnchorFollowing();
+    m_addingItem = false;
+
+    return item;
+}
+
+void LayoutSolver::removeItem(int item)
+{
+    if (item < 0 || item >= m_model.items.size()) {
+        qWarning() << Q_FUNC_INFO << "Invalid item" << item;
+        return;
+    }
+
+    detach();
+
+    // Same as AnchorGroup::removeItem()
+    const ItemData &group = m_model.items.at(item);
+    const int left = group.leftAnchor;
+    const int top = group.topAnchor;
+    const int right = group.rightAnchor;
+    const int bottom = group.bottomAnchor;
+
+    removeItemFromAnchor(left, item);
+    removeItemFromAnchor(right, item);
+    removeItemFromAnchor(bottom, item);
+    removeItemFromAnchor(top, item);
+
+    if (m_model.anchors.at(left).isUnneeded()) {
+        updateAnchorsFromTo(left, right);
+        const int leftPosition = m_model.anchors.at(left).position;
+        consume(right, left, AnchorData::Side1);
+
+        const AnchorData &r = m_model.anchors.at(right);
+        if (!r.isUnneeded() && !r.isStatic()) {
+            // Make use of the extra space, so it's fair
+            setAnchorPosition(right, r.position - ((r.position - leftPosition) / 2));
+        }
+    }
+
+    if (m_model.anchors.at(right).isUnneeded()) {
+        updateAnchorsFromTo(right, left);
+        consume(left, right, AnchorData::Side2);
+    }
+
+    if (m_model.anchors.at(top).isUnneeded()) {
+        updateAnchorsFromTo(top, bottom);
+        const int topPosition = m_model.anchors.at(top).position;
+        consume(bottom, top, AnchorData::Side1);
+
+        const AnchorData &b = m_model.anchors.at(bottom);
+        if (!b.isUnneeded() && !b.isStatic()) {
+            // Make use of the extra space, so it's fair
+            setAnchorPosition(bottom, b.position - ((b.position - topPosition) / 2));
+        }
+    }
+
+    if (m_model.anchors.at(bottom).isUnneeded()) {
+        updateAnchorsFromTo(bottom, top);
+        consume(top, bottom, AnchorData::Side2);
+    }
+
+    compact(item);
+    updateAnchorFollowing();
+}
+
+void LayoutSolver::ensureItemsMinSize()
+{
+    detach();
+    auto setPosition = [this] (int anchor, int position) {
+        setAnchorPosition(anchor, position);
+    };
+
+    for (int i = 0; i < m_model.items.size(); ++i) {
+        LayoutMath<Graph>::ensureMinSize(Graph(this), i, Qt::Vertical, setPosition);
+        LayoutMath<Graph>::ensureMinSize(Graph(this), i, Qt::Horizontal, setPosition);
+    }
+}
+
+void LayoutSolver::detach()
+{
+    // The model might be shared with a copy of model(), detach before solving, so references
+    // into the vectors stay valid meanwhile
+    m_model.anchors.detach();
+    m_model.items.detach();
+}
+
+int LayoutSolver::length(Qt::Orientation orientation) const
+{
+    return lengthFromSize(m_model.size, orientation);
+}
+
+int LayoutSolver::endFollowee(int anchor) const
+{
+    while (m_model.anchors.at(anchor).isFollowing())
+        anchor = m_model.anchors.at(anchor).followee;
+
+    return anchor;
+}
+
+int LayoutSolver::minPosition(int anchor) const
+{
+    const AnchorData &a = m_model.anchors.at(anchor);
+    int smallestSqueeze = 0;
+    bool firstElement = true;
+    for (int itemIndex : a.side1Items) {
+        const ItemData &item = m_model.items.at(itemIndex);
+        const int availableSqueeze = lengthFromSize(item.geometry.size(), a.orientation)
+                                   - lengthFromSize(item.minimumSize(), a.orientation);
+        if (availableSqueeze < smallestSqueeze || firstElement) {
+            smallestSqueeze = availableSqueeze;
+            firstElement = false;
+        }
+    }
+
+    return a.position - smallestSqueeze;
+}
+
+bool LayoutSolver::hasNonPlaceholderItems(int anchor, AnchorData::Side side) const
+{
+    for (int itemIndex : m_model.anchors.at(anchor).items(side)) {
+        if (!m_model.items.at(itemIndex).isPlaceholder)
+            return true;
+    }
+
+    return false;
+}
+
+bool LayoutSolver::hasVisibleItems() const
+{
+    for (const ItemData &item : m_model.items) {
+        if (!item.isPlaceholder)
+            return true;
+    }
+
+    return false;
+}
+
+int LayoutSolver::findNearestAnchorWithItems(int anchor, AnchorData::Side side) const
+{
+    // Same as Anchor::findNearestAnchorWithItems()
+    const AnchorData &a = m_model.anchors.at(anchor);
+    int candidate = -1;
+    for (int item : a.items(side)) {
+        int nearest = m_model.items.at(item).anchorAtSide(side, a.orientation);
+        if (!hasNonPlaceholderItems(nearest, side))
+            nearest = findNearestAnchorWithItems(nearest, side);
+
+        const int position = m_model.anchors.at(nearest).position;
+        if (candidate == -1 || (side == AnchorData::Side1 && position > m_model.anchors.at(candidate).position)
+                            || (side == AnchorData::Side2 && position < m_model.anchors.at(candidate).position)) {
+            candidate = nearest;
+        }
+    }
+
+    return candidate == -1 ? staticAnchor(side, a.orientation)
+                           : candidate;
+}
+
+int LayoutSolver::staticAnchor(AnchorData::Side side, Qt::Orientation orientation) const
+{
+    if (orientation == Qt::Vertical)
+        return side == AnchorData::Side1 ? m_model.leftAnchor : m_model.rightAnchor;
+
+    return side == AnchorData::Side1 ? m_model.topAnchor : m_model.bottomAnchor;
+}
+
+ItemData LayoutSolver::anchorGroup(int item) const
+{
+    if (item != -1)
+        return m_model.items.at(item);
+
+    ItemData group;
+    group.leftAnchor = m_model.leftAnchor;
+    group.topAnchor = m_model.topAnchor;
+    group.rightAnchor = m_model.rightAnchor;
+    group.bottomAnchor = m_model.bottomAnchor;
+    return group;
+}
+
+DropLength LayoutSolver::lengthForDrop(QSize minSize, QSize preferredSize, Location location, int relativeTo) const
+{
+    const Qt::Orientation orientation = anchorOrientationForLocation(location);
+    const int anchor = anchorForLocation(anchorGroup(relativeTo), location);
+    const DropLength available = LayoutMath<Graph>::availableLengthForDrop(Graph(this), anchor, hasVisibleItems());
+
+    return LayoutMath<Graph>::lengthForDrop(Graph(this), available, orientation,
+                                            lengthFromSize(minSize, orientation),
+                                            lengthFromSize(preferredSize, orientation));
+}
+
+void LayoutSolver::setAnchorPosition(int anchor, int position, bool dontRecalculatePercentage)
+{
+    AnchorData &a = m_model.anchors[anchor];
+    const int max = length(a.orientation) - m_model.staticAnchorThickness;
+    if ((position < 0 || position > max) && (m_addingItem || m_resizing)) {
+        // Same as Anchor::setPosition(), ensureAnchorsBounded() is run when finished
+        return;
+    }
+
+    if (a.position == position) {
+        updateItemGeometries(anchor);
+        return;
+    }
+
+    a.position = position;
+    if (!dontRecalculatePercentage && !m_resizing)
+        a.positionPercentage = (position * 1.0) / length(a.orientation);
+
+    // Followers get the same position, like Anchor::onFolloweePositionChanged()
+    for (int follower : qAsConst(a.followers))
+        setAnchorPosition(follower, position);
+
+    updateItemGeometries(anchor);
+}
+
+void LayoutSolver::updateItemGeometries(int anchor)
+{
+    // Same as Anchor::updateItemSizes(). And like Item::setGeometry(), an item squeezed below
+    // its min size pushes its opposite anchor
+    auto setPosition = [this] (int anchor, int position) {
+        setAnchorPosition(anchor, position);
+    };
+
+    const AnchorData &a = m_model.anchors.at(anchor);
+    int position = a.position;
+    for (int itemIndex : a.side2Items) {
+        ItemData &item = m_model.items[itemIndex];
+        if (item.isPlaceholder)
+            continue;
+
+        QRect geometry = item.geometry;
+        geometry.setTopLeft(a.isVertical() ? QPoint(position + a.thickness, geometry.y())
+                                           : QPoint(geometry.x(), position + a.thickness));
+        if (geometry != item.geometry) {
+            item.geometry = geometry;
+            if (item.hasAllAnchors())
+                LayoutMath<Graph>::ensureMinSize(Graph(this), itemIndex, a.orientation, AnchorData::Side2, setPosition);
+        }
+    }
+
+    position = a.position;
+    for (int itemIndex : a.side1Items) {
+        ItemData &item = m_model.items[itemIndex];
+        if (item.isPlaceholder)
+            continue;
+
+        // -1 as the widget is right next to the anchor, and not on top
+        QRect geometry = item.geometry;
+        geometry.setBottomRight(a.isVertical() ? QPoint(position - 1, geometry.bottom())
+                                               : QPoint(geometry.right(), position - 1));
+        if (geometry != item.geometry) {
+            item.geometry = geometry;
+            if (item.hasAllAnchors())
+                LayoutMath<Graph>::ensureMinSize(Graph(this), itemIndex, a.orientation, AnchorData::Side1, setPosition);
+        }
+    }
+}
+
+void LayoutSolver::positionStaticAnchors()
+{
+    setAnchorPosition(m_model.leftAnchor, 0);
+    setAnchorPosition(m_model.topAnchor, 0);
+    setAnchorPosition(m_model.bottomAnchor, m_model.size.height() - m_model.anchors.at(m_model.bottomAnchor).thickness);
+    setAnchorPosition(m_model.rightAnchor, m_model.size.width() - m_model.anchors.at(m_model.rightAnchor).thickness);
+}
+
+void LayoutSolver::ensureAnchorsBounded()
+{
+    positionStaticAnchors();
+    ensureItemsMinSize();
+}
+
+void LayoutSolver::updateSizeConstraints()
+{
+    // Like MultiSplitterLayout::setMinimumSize(), the layout grows if it's too small now
+    const QSize size = m_model.size.expandedTo(minimumSize());
+    if (size != m_model.size)
+        resize(size);
+}
+
+void LayoutSolver::ensureEnoughSize(QSize minSize, QSize preferredSize, Location location, int relativeTo)
+{
+    const int neededAnchorThickness = m_model.items.isEmpty() ? 0 : m_model.anchorThickness;
+    const bool needsNewAnchor = hasVisibleItems();
+    const QSize available(LayoutMath<Graph>::availableLengthForDrop(Graph(this), m_model.leftAnchor, needsNewAnchor).length(),
+                          LayoutMath<Graph>::availableLengthForDrop(Graph(this), m_model.topAnchor, needsNewAnchor).length());
+    const int neededWidth = minSize.width() - available.width() + neededAnchorThickness;
+    const int neededHeight = minSize.height() - available.height() + neededAnchorThickness;
+
+    QSize newSize = m_model.size;
+    if (neededWidth > 0)
+        newSize.setWidth(newSize.width() + neededWidth);
+    if (neededHeight > 0)
+        newSize.setHeight(newSize.height() + neededHeight);
+
+    if (newSize != m_model.size)
+        resize(newSize);
+
+    if (lengthForDrop(minSize, preferredSize, location, relativeTo).isNull()) {
+        qWarning() << Q_FUNC_INFO << "failed!"
+                   << "; oldAvailable=" << available
+                   << "; newSize=" << newSize
+                   << "; minSize=" << minSize;
+    }
+}
+
+int LayoutSolver::createAnchorFrom(int other, int relativeTo, int from, int to)
+{
+    // Same as Anchor::createFrom() and AnchorGroup::createAnchorFrom(). The new anchor doesn't have
+    // a position yet, so the items it takes keep their geometry.
+    AnchorData anchor;
+    anchor.orientation = m_model.anchors.at(other).orientation;
+    anchor.thickness = m_model.anchorThickness;
+    anchor.from = from;
+    anchor.to = to;
+
+    const int index = m_model.anchors.size();
+    m_model.anchors.push_back(anchor);
+
+    QVector<int> side1Items;
+    QVector<int> side2Items;
+    if (relativeTo != -1) {
+        if (m_model.anchors.at(other).side1Items.contains(relativeTo))
+            side1Items.push_back(relativeTo);
+        else
+            side2Items.push_back(relativeTo);
+    } else {
+        side1Items = m_model.anchors.at(other).side1Items;
+        side2Items = m_model.anchors.at(other).side2Items;
+    }
+
+    for (int item : qAsConst(side1Items)) {
+        removeItemFromAnchor(other, item);
+        m_model.anchors[index].side1Items.push_back(item);
+        m_model.items[item].anchorAtSide(AnchorData::Side2, anchor.orientation) = index;
+    }
+
+    for (int item : qAsConst(side2Items)) {
+        removeItemFromAnchor(other, item);
+        m_model.anchors[index].side2Items.push_back(item);
+        m_model.items[item].anchorAtSide(AnchorData::Side1, anchor.orientation) = index;
+    }
+
+    m_cumulativeMinLengthCache.clear();
+    return index;
+}
+
+void LayoutSolver::addItemToAnchor(int anchor, int item, AnchorData::Side side)
+{
+    // Same as Anchor::addItem()
+    AnchorData &a = m_model.anchors[anchor];
+    if (a.items(side).contains(item))
+        return;
+
+    a.items(side).push_back(item);
+    m_model.items[item].anchorAtSide(oppositeSide(side), a.orientation) = anchor;
+    m_cumulativeMinLengthCache.clear();
+    updateItemGeometries(anchor);
+}
+
+void LayoutSolver::removeItemFromAnchor(int anchor, int item)
+{
+    // Same as Anchor::removeItem()
+    AnchorData &a = m_model.anchors[anchor];
+    if (a.side1Items.removeOne(item)) {
+        m_model.items[item].anchorAtSide(AnchorData::Side2, a.orientation) = -1;
+    } else if (a.side2Items.removeOne(item)) {
+        m_model.items[item].anchorAtSide(AnchorData::Side1, a.orientation) = -1;
+    } else {
+        return;
+    }
+
+    m_cumulativeMinLengthCache.clear();
+}
+
+void LayoutSolver::consume(int anchor, int other, AnchorData::Side side)
+{
+    // Same as Anchor::consume()
+    const QVector<int> items = m_model.anchors.at(other).items(side);
+    for (int item : items)
+        removeItemFromAnchor(other, item);
+    for (int item : items)
+        addItemToAnchor(anchor, item, side);
+
+    if (m_model.anchors.at(other).isUnneeded()) {
+        // Before deleting an unneeded anchor, the anchors following it must follow us instead
+        const QVector<int> followers = m_model.anchors.at(other).followers;
+        for (int follower : followers) {
+            if (follower != anchor)
+                setFollowee(follower, anchor);
+        }
+
+        deleteAnchor(other);
+    }
+}
+
+void LayoutSolver::deleteAnchor(int anchor)
+{
+    // Same as ~Anchor(), the actual removal is done by compact()
+    const QVector<int> followers = m_model.anchors.at(anchor).followers;
+    for (int follower : followers)
+        setFollowee(follower, -1);
+    setFollowee(anchor, -1);
+
+    const AnchorData &a = m_model.anchors.at(anchor);
+    for (int item : a.side1Items)
+        m_model.items[item].anchorAtSide(AnchorData::Side2, a.orientation) = -1;
+    for (int item : a.side2Items)
+        m_model.items[item].anchorAtSide(AnchorData::Side1, a.orientation) = -1;
+
+    m_deadAnchors.push_back(anchor);
+    m_cumulativeMinLengthCache.clear();
+}
+
+void LayoutSolver::updateAnchorsFromTo(int oldAnchor, int newAnchor)
+{
+    // Same as MultiSplitterLayout::updateAnchorsFromTo()
+    const Qt::Orientation orientation = m_model.anchors.at(newAnchor).orientation;
+    for (AnchorData &other : m_model.anchors) {
+        if (!other.isStatic() && other.orientation != orientation) {
+            if (other.to == oldAnchor) {
+                other.to = newAnchor;
+            } else if (other.from == oldAnchor) {
+                other.from = newAnchor;
+            }
+        }
+    }
+}
+
+void LayoutSolver::setFollowee(int anchor, int followee)
+{
+    // Same as Anchor::setFollowee()
+    AnchorData &a = m_model.anchors[anchor];
+    if (a.followee == followee)
+        return;
+
+    if (a.isFollowing())
+        m_model.anchors[a.followee].followers.removeOne(anchor);
+
+    a.followee = followee;
+    setThickness(anchor);
+    if (followee != -1) {
+        m_model.anchors[followee].followers.push_back(anchor);
+        setAnchorPosition(anchor, m_model.anchors.at(followee).position);
+    }
+}
+
+void LayoutSolver::setThickness(int anchor)
+{
+    // Same as Anchor::setThickness(), followers have their followee's thickness
+    AnchorData &a = m_model.anchors[anchor];
+    const int thickness = a.isFollowing() ? m_model.anchors.at(a.followee).thickness
+                                          : (a.isStatic() ? m_model.staticAnchorThickness : m_model.anchorThickness);
+    if (thickness == a.thickness)
+        return;
+
+    a.thickness = thickness;
+    for (int follower : qAsConst(a.followers))
+        setThickness(follower);
+}
+
+void LayoutSolver::updateAnchorFollowing()
+{
+    // Same as MultiSplitterLayout::updateAnchorFollowing(), without a group being removed
+    for (int i = 0; i < m_model.anchors.size(); ++i)
+        setFollowee(i, -1);
+
+    for (int i = 0; i < m_model.anchors.size(); ++i) {
+        if (m_model.anchors.at(i).isStatic())
+            continue;
+
+        for (AnchorData::Side side : { AnchorData::Side2, AnchorData::Side1 }) {
+            if (!hasNonPlaceholderItems(i, side)) {
+                const int toFollow = findNearestAnchorWithItems(i, side);
+                if (m_model.anchors.at(toFollow).followee != i)
+                    setFollowee(i, toFollow);
+                break;
+            }
+        }
+    }
+
+    updateSizeConstraints();
+    ensureAnchorsBounded();
+}
+
+void LayoutSolver::compact(int removedItem)
+{
+    // Maps the old anchor indexes to the new ones, -1 for the deleted anchors
+    QVector<int> anchorIndexes(m_model.anchors.size());
+    int count = 0;
+    for (int i = 0; i < anchorIndexes.size(); ++i)
+        anchorIndexes[i] = m_deadAnchors.contains(i) ? -1 : count++;
+
+    auto updateAnchorIndex = [&anchorIndexes] (int &index) {
+        if (index != -1)
+            index = anchorIndexes.at(index);
+    };
+
+    auto updateItemIndex = [removedItem] (int &index) {
+        if (index > removedItem)
+            --index;
+    };
+
+    QVector<AnchorData> anchors;
+    anchors.reserve(count);
+    for (int i = 0; i < m_model.anchors.size(); ++i) {
+        if (anchorIndexes.at(i) == -1)
+            continue;
+
+        AnchorData a = m_model.anchors.at(i);
+        updateAnchorIndex(a.from);
+        updateAnchorIndex(a.to);
+        updateAnchorIndex(a.followee);
+        for (int &follower : a.followers)
+            updateAnchorIndex(follower);
+        a.followers.removeAll(-1);
+        for (int &item : a.side1Items)
+            updateItemIndex(item);
+        for (int &item : a.side2Items)
+            updateItemIndex(item);
+        anchors.push_back(a);
+    }
+
+    m_model.anchors = anchors;
+    m_model.items.remove(removedItem);
+    for (ItemData &item : m_model.items) {
+        updateAnchorIndex(item.leftAnchor);
+        updateAnchorIndex(item.topAnchor);
+        updateAnchorIndex(item.rightAnchor);
+        updateAnchorIndex(item.bottomAnchor);
+    }
+
+    updateAnchorIndex(m_model.leftAnchor);
+    updateAnchorIndex(m_model.topAnchor);
+    updateAnchorIndex(m_model.rightAnchor);
+    updateAnchorIndex(m_model.bottomAnchor);
+
+    m_deadAnchors.clear();
+    m_cumulativeMinLengthCache.clear();
+}
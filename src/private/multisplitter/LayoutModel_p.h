@@ -0,0 +1,655 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @brief A widget-free copy of a MultiSplitterLayout, and the layout math shared with it.
+ *
+ * @author Sérgio Martins \<sergio.martins@kdab.com\>
+ */
+
+#ifndef KD_MULTISPLITTER_LAYOUTMODEL_P_H
+#define KD_MULTISPLITTER_LAYOUTMODEL_P_H
+
+#include "docks_export.h"
+#include "KDDockWidgets.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QPair>
+#include <QRect>
+#include <QVector>
+#include <QtMath>
+
+#include <utility>
+
+namespace KDDockWidgets {
+
+/**
+ * @brief The plain data of an Anchor. Items and anchors are referenced by index.
+ */
+struct AnchorData
+{
+    enum Side {
+        Side1 = 1, ///< Same values as Anchor::Side
+        Side2
+    };
+
+    Qt::Orientation orientation = Qt::Vertical;
+    int type = 0; ///< Anchor::Type
+    int position = 0;
+    int thickness = 0;
+    qreal positionPercentage = 0.0;
+    int from = -1;
+    int to = -1;
+    int followee = -1;
+    QVector<int> followers; ///< The anchors whose followee is this one
+    QVector<int> side1Items;
+    QVector<int> side2Items;
+
+    bool isVertical() const { return orientation == Qt::Vertical; }
+    bool isStatic() const { return type != 0; }
+    bool isFollowing() const { return followee != -1; }
+    ///@brief Like Anchor::isUnneeded(), a non-static anchor needs items at both sides
+    bool isUnneeded() const { return !isStatic() && (side1Items.isEmpty() || side2Items.isEmpty()); }
+    const QVector<int> &items(Side side) const { return side == Side1 ? side1Items : side2Items; }
+    QVector<int> &items(Side side) { return side == Side1 ? side1Items : side2Items; }
+};
+
+/**
+ * @brief The plain data of an Item
+ */
+struct ItemData
+{
+    QRect geometry;
+    QSize minSize;
+    bool isPlaceholder = false;
+    int leftAnchor = -1;
+    int topAnchor = -1;
+    int rightAnchor = -1;
+    int bottomAnchor = -1;
+
+    ///@brief Like Item::minimumSize(), placeholders don't have a min size
+    QSize minimumSize() const { return isPlaceholder ? QSize(0, 0) : minSize; }
+    int anchorAtSide(AnchorData::Side side, Qt::Orientation orientation) const;
+    int &anchorAtSide(AnchorData::Side side, Qt::Orientation orientation);
+    bool hasAllAnchors() const { return leftAnchor != -1 && topAnchor != -1 && rightAnchor != -1 && bottomAnchor != -1; }
+};
+
+/**
+ * @brief A snapshot of a MultiSplitterLayout, see MultiSplitterLayout::toLayoutModel().
+ *
+ * Doesn't reference any QObject, so it can be copied around and solved in any thread.
+ */
+struct LayoutModel
+{
+    QSize size;
+    int staticAnchorThickness = 0;
+    int anchorThickness = 0;
+    int leftAnchor = -1;
+    int topAnchor = -1;
+    int rightAnchor = -1;
+    int bottomAnchor = -1;
+    QVector<AnchorData> anchors;
+    QVector<ItemData> items;
+};
+
+/**
+ * @brief The length a dropped item gets, split by how much of it comes from each side of the anchor
+ * it's dropped next to. See MultiSplitterLayout::lengthForDrop().
+ */
+struct DropLength {
+    DropLength() = default;
+    DropLength(int side1, int side2)
+        : side1Length(side1)
+        , side2Length(side2)
+    {}
+
+    int side1Length = 0;
+    int side2Length = 0;
+    int length() const { return side1Length + side2Length; }
+
+    void setLength(int newLength)
+    {
+        // Sets the new length, preserving proportion
+        side1Length = int(side1Factor() * newLength);
+        side2Length = newLength - side1Length;
+    }
+
+    bool isNull() const
+    {
+        return length() <= 0;
+    }
+
+private:
+    qreal side1Factor() const
+    {
+        return (1.0 * side1Length) / length();
+    }
+};
+
+///@brief The biggest sum of min lengths between an anchor and a static anchor, see LayoutMath::cumulativeMinLength()
+struct CumulativeMin
+{
+    int minLength;
+    int numItems;
+    CumulativeMin& operator+=(CumulativeMin other) {
+        minLength += other.minLength;
+        numItems += other.numItems;
+        return *this;
+    }
+};
+
+/**
+ * @brief The layout math, written once for both LayoutSolver and MultiSplitterLayout.
+ *
+ * @p Graph gives access to the anchors and items of either a LayoutModel or a live layout.
+ * Anchors are referenced by Graph::AnchorRef, items by Graph::ItemRef. Functions that move anchors
+ * don't do it themselves, they call a setPosition(anchor, position) functor instead.
+ */
+template <typename Graph>
+struct LayoutMath
+{
+    typedef typename Graph::AnchorRef AnchorRef;
+    typedef typename Graph::ItemRef ItemRef;
+
+    /**
+     * @brief Returns the length needed between @p anchor and the static anchor at side @p side,
+     * so all items in between get their min length. Includes the anchors' thickness.
+     */
+    static int cumulativeMinLength(const Graph &g, AnchorRef anchor, AnchorData::Side side)
+    {
+        if (g.isStatic(anchor) && g.isEmpty(anchor)) {
+            // There's no widget, but minimum is the space occupied by left+right anchors (or top+bottom).
+            const bool isLeftOrTop = g.isLeftOrTopStatic(anchor);
+            if ((side == AnchorData::Side2 && isLeftOrTop) || (side == AnchorData::Side1 && !isLeftOrTop))
+                return 2 * g.staticAnchorThickness();
+        }
+
+        const CumulativeMin result = cumulativeMinLength_recursive(g, anchor, side);
+        const int numNonStaticAnchors = result.numItems >= 2 ? result.numItems - 1
+                                                             : 0;
+
+        return g.defaultThickness(anchor) + g.staticAnchorThickness()
+               + numNonStaticAnchors * g.anchorThickness()
+               + result.minLength;
+    }
+
+    ///@brief Returns how far left/top and right/bottom @p anchor can go, respecting the min sizes
+    static QPair<int, int> boundPositions(const Graph &g, AnchorRef anchor)
+    {
+        if (g.isLeftOrTopStatic(anchor))
+            return { 0, 0 };
+
+        if (g.isRightOrBottomStatic(anchor)) {
+            const int max = g.length(g.orientation(anchor)) - g.staticAnchorThickness();
+            return { max, max };
+        }
+
+        if (g.isFollowing(anchor))
+            anchor = g.endFollowee(anchor);
+
+        const int minSide1Length = cumulativeMinLength(g, anchor, AnchorData::Side1);
+        const int minSide2Length = cumulativeMinLength(g, anchor, AnchorData::Side2);
+
+        return { qMax(0, minSide1Length - g.thickness(anchor)),
+                 qMax(0, g.length(g.orientation(anchor)) - minSide2Length) };
+    }
+
+    /**
+     * @brief Moves the anchors at side2 of @p fromAnchor according to their position percentage,
+     * after the layout was resized. @p setPosition is called with each anchor and its new position.
+     */
+    template <typename SetPosition>
+    static void redistributeSpace_recursive(const Graph &g, AnchorRef fromAnchor, int minAnchorPos,
+                                            const SetPosition &setPosition)
+    {
+        const Qt::Orientation orientation = g.orientation(fromAnchor);
+        const auto items = g.items(fromAnchor, AnchorData::Side2);
+        for (auto item : items) {
+            const AnchorRef nextAnchor = g.anchorAtSide(item, AnchorData::Side2, orientation);
+            if (g.isStatic(nextAnchor))
+                continue;
+
+            // We use the minPos of the Anchor that had non-placeholder items on its side1.
+            if (g.hasNonPlaceholderItems(nextAnchor, AnchorData::Side1))
+                minAnchorPos = g.minPosition(nextAnchor);
+
+            if (g.hasNonPlaceholderItems(nextAnchor, AnchorData::Side2) && !g.isFollowing(nextAnchor)) {
+                const int newPosition = int(g.positionPercentage(nextAnchor) * g.length(orientation));
+
+                // But don't let the anchor go out of bounds, it must respect its widgets min sizes.
+                // Also bound by minAnchorPos, as we're not making the anchors on the left/top shift, which boundPositions() assumes.
+                const QPair<int, int> bounds = boundPositions(g, nextAnchor);
+                setPosition(nextAnchor, qMax(bounds.first, qBound(minAnchorPos, newPosition, bounds.second)));
+            }
+
+            redistributeSpace_recursive(g, nextAnchor, minAnchorPos, setPosition);
+        }
+    }
+
+    /**
+     * @brief Returns how much space an item dropped next to @p anchor can get, from each of its sides.
+     * If @p needsNewAnchor then the thickness of the anchor that will be created is already discounted.
+     */
+    static DropLength availableLengthForDrop(const Graph &g, AnchorRef anchor, bool needsNewAnchor)
+    {
+        const int thisLength = g.length(g.orientation(anchor));
+        if (g.isFollowing(anchor))
+            anchor = g.endFollowee(anchor);
+
+        const int minForAlreadyOccupied1 = cumulativeMinLength(g, anchor, AnchorData::Side1) - g.thickness(anchor); // TODO: Check if this is correct, we're discounting the anchor twice
+        const int minForAlreadyOccupied2 = cumulativeMinLength(g, anchor, AnchorData::Side2) - g.thickness(anchor);
+
+        const int side1AvailableLength = g.position(anchor) - minForAlreadyOccupied1;
+        const int side2AvailableLength = thisLength - (g.position(anchor) + g.thickness(anchor)) - minForAlreadyOccupied2;
+
+        // This useless space doesn't belong to side1 or side2 specifically. So account for it separately.
+        const int unusableSpace = needsNewAnchor ? g.anchorThickness() : 0;
+
+        DropLength result;
+        const int usableLength = qMax(0, side1AvailableLength + side2AvailableLength - unusableSpace);
+        if (usableLength > 0) {
+            qreal factor = (side1AvailableLength * 1.0) / (side1AvailableLength + side2AvailableLength);
+            result.side1Length = int(qRound(usableLength * factor)); // rounding not really needed, but makes things more fair probably
+            result.side2Length = usableLength - result.side1Length;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Returns the length a dropped item gets out of the @p available one, given its @p minLength
+     * and its current length, @p preferredLength. Returns a null length if there's not enough space.
+     */
+    static DropLength lengthForDrop(const Graph &g, DropLength available, Qt::Orientation orientation,
+                                    int minLength, int preferredLength)
+    {
+        if (available.length() < minLength)
+            return {};
+
+        const int suggestedLength = qMin(preferredLength, int(0.4 * g.length(orientation)));
+        available.setLength(qBound(minLength, suggestedLength, available.length()));
+        return available;
+    }
+
+    ///@brief Returns the geometry of an item dropped at @p location of @p relativeToRect, with length @p lfd
+    static QRect rectForDrop(const Graph &g, DropLength lfd, Location location, QRect relativeToRect, bool needsNewAnchor)
+    {
+        const int widgetLength = lfd.length();
+        const int newAnchorThickness = needsNewAnchor ? g.anchorThickness() : 0;
+        const int side1Length = lfd.side1Length;
+        const int staticAnchorThickness = g.staticAnchorThickness();
+
+        switch (location) {
+        case Location_OnLeft:
+            return QRect(qMax(0, relativeToRect.x() - side1Length), relativeToRect.y(),
+                         widgetLength, relativeToRect.height());
+        case Location_OnTop:
+            return QRect(relativeToRect.x(), qMax(0, relativeToRect.y() - side1Length),
+                         relativeToRect.width(), widgetLength);
+        case Location_OnRight:
+            return QRect(qMin(relativeToRect.right() + 1 - side1Length + newAnchorThickness,
+                              g.length(Qt::Vertical) - widgetLength - staticAnchorThickness), relativeToRect.y(), widgetLength, relativeToRect.height());
+        case Location_OnBottom:
+            return QRect(relativeToRect.x(), qMin(relativeToRect.bottom() + 1 - side1Length + newAnchorThickness,
+                                                  g.length(Qt::Horizontal) - widgetLength - staticAnchorThickness),
+                         relativeToRect.width(), widgetLength);
+        default:
+            return QRect();
+        }
+    }
+
+    /**
+     * @brief Shifts the interval [@p newPos1, @p newPos2] so @p anchor1 and @p anchor2 stay within
+     * their bounds, if there's enough space.
+     */
+    static std::pair<int, int> boundInterval(const Graph &g, int newPos1, AnchorRef anchor1, int newPos2, AnchorRef anchor2)
+    {
+        const int bound1 = boundPositions(g, anchor1).first;
+        const int bound2 = boundPositions(g, anchor2).second;
+
+        if (newPos1 >= bound1 && newPos2 <= bound2) {
+            // Simplest case, it's bounded.
+            return { newPos1, newPos2 };
+        }
+
+        if (newPos1 < bound1) {
+            // the anchor1 is out of bounds
+
+            const int bythismuch = bound1 - newPos1;
+            newPos1 = bound1;
+            newPos2 = newPos2 + bythismuch;
+
+            if (newPos2 > bound2) {
+                qWarning() << "Adjusted interval still out of bounds. Not enough space. #1"
+                           << "; newPos1=" << newPos1
+                           << "; newPos2=" << newPos2
+                           << "; bounds=" << bound1 << bound2
+                           << "; anchor1=" << anchor1
+                           << "; anchor2=" << anchor2
+                           << "; length=" << g.length(g.orientation(anchor1));
+            }
+        } else if (newPos2 > bound2) {
+            // the anchor2 is out of bounds
+
+            const int bythismuch = newPos2 - bound2;
+            newPos2 = bound2;
+            newPos1 = newPos1 - bythismuch;
+
+            if (newPos1 < bound1) {
+                qWarning() << "Adjusted interval still out of bounds. Not enough space. #2"
+                           << "; newPos1=" << newPos1
+                           << "; newPos2=" << newPos2
+                           << "; bounds=" << bound1 << bound2
+                           << "; anchor1=" << anchor1
+                           << "; anchor2=" << anchor2
+                           << "; length=" << g.length(g.orientation(anchor1));
+            }
+        }
+
+        return { newPos1, newPos2 };
+    }
+
+    /**
+     * @brief After @p fromAnchor moved by @p delta, makes the anchors after it, towards @p direction,
+     * contribute some space too. So not only the adjacent items shrink.
+     */
+    template <typename SetPosition>
+    static void propagateResize(const Graph &g, int delta, AnchorRef fromAnchor, AnchorData::Side direction,
+                                const SetPosition &setPosition)
+    {
+        // Every path from fromAnchor to the static anchor shares the delta among its anchors, and the
+        // smallest paths contribute first, as they can afford to give more space per anchor. So each
+        // anchor moves by what the smallest path containing it gives. As the bounds only depend on the
+        // static anchors and min sizes, they don't change while we move anchors, and the paths don't
+        // need to be enumerated, just the length of the smallest path through each anchor.
+        // That's the anchors before it, from a breadth first walk, plus the anchors after it.
+        QHash<AnchorRef, int> lengthsToStatic;
+        QHash<AnchorRef, int> distances = { { fromAnchor, 0 } };
+        QVector<AnchorRef> anchors = { fromAnchor };
+        for (int i = 0; i < anchors.size(); ++i) {
+            const AnchorRef anchor = anchors.at(i);
+            const int distance = distances.value(anchor) + 1;
+            const auto items = g.items(anchor, direction);
+            for (auto item : items) {
+                const AnchorRef next = g.anchorAtSide(item, direction, g.orientation(anchor));
+                if (!g.isStatic(next) && !distances.contains(next)) {
+                    distances.insert(next, distance);
+                    anchors.push_back(next);
+                }
+            }
+        }
+
+        const bool towardsSide1 = direction == AnchorData::Side1;
+        const bool towardsSide2 = !towardsSide1;
+        const int sign = towardsSide1 ? -1 : 1;
+
+        // The initial anchor already contributed
+        for (int i = 1, end = anchors.size(); i < end; ++i) {
+            const AnchorRef a = anchors.at(i);
+            const int pathLength = distances.value(a) + shortestLengthToStatic(g, a, direction, lengthsToStatic);
+
+            const int contributionPerAnchor = (delta / (pathLength - 1)) * sign; // n-1 because the initial anchor already contributed
+            if (qAbs(contributionPerAnchor) < 5) {
+                // Too small, don't bother
+                continue;
+            }
+
+            // When moving anchors don't allow widgets to go bellow their min size
+            const QPair<int, int> bounds = boundPositions(g, a);
+            const int bound = towardsSide1 ? bounds.first : bounds.second;
+            int newPosition = g.position(a) + contributionPerAnchor;
+            if ((towardsSide1 && newPosition < bound) ||
+                (towardsSide2 && newPosition > bound)) {
+                newPosition = bound;
+            }
+
+            if (g.position(a) != newPosition)
+                setPosition(a, newPosition);
+        }
+    }
+
+    /**
+     * @brief Pushes the anchors around @p item away from each other, if it's smaller than its min length.
+     * Each anchor stays within its bounds.
+     */
+    template <typename SetPosition>
+    static void ensureMinSize(const Graph &g, ItemRef item, Qt::Orientation orientation, const SetPosition &setPosition)
+    {
+        if (g.isPlaceholder(item))
+            return;
+
+        const int minLength = g.minLength(item, orientation);
+        const int delta = g.itemLength(item, orientation) - minLength;
+        if (delta >= 0) // Our size is just fine
+            return;
+
+        const int newLength = minLength;
+
+        AnchorRef anchor1 = g.anchorAtSide(item, AnchorData::Side1, orientation);
+        AnchorRef anchor2 = g.anchorAtSide(item, AnchorData::Side2, orientation);
+
+        anchor1 = g.isFollowing(anchor1) ? g.endFollowee(anchor1) : anchor1;
+        anchor2 = g.isFollowing(anchor2) ? g.endFollowee(anchor2) : anchor2;
+
+        const int bound1 = boundPositions(g, anchor1).first;
+        const int bound2 = boundPositions(g, anchor2).second;
+
+        // If vertical, anchor1 is the left separator and anchor2 is the right one. We'll push anchor1
+        // further left and anchor2 further right.
+
+        const int position1 = g.position(anchor1);
+        const int thickness1 = g.thickness(anchor1);
+        const int suggestedDelta1 = qMin(delta, qCeil(delta / 2) + thickness1 + 1);
+        const int maxPos1 = bound2 - newLength - thickness1;
+        const int newPosition1 = qMin(position1, qMax(qMin(maxPos1, position1 - suggestedDelta1), bound1)); // Honour the bound
+        const int newPosition2 = newPosition1 + thickness1 + newLength; // No need to check bound2, we have enough space afterall
+
+        if (!g.isStatic(anchor1))
+            setPosition(anchor1, newPosition1);
+        if (!g.isStatic(anchor2))
+            setPosition(anchor2, newPosition2);
+    }
+
+    /**
+     * @brief Moves the anchor at @p side of @p item, if it's smaller than its min length.
+     * Called after the anchor at the other side squeezed it.
+     */
+    template <typename SetPosition>
+    static void ensureMinSize(const Graph &g, ItemRef item, Qt::Orientation orientation, AnchorData::Side side,
+                              const SetPosition &setPosition)
+    {
+        if (g.isPlaceholder(item))
+            return;
+
+        const int delta = g.itemLength(item, orientation) - g.minLength(item, orientation);
+        if (delta >= 0) // Our size is just fine
+            return;
+
+        AnchorRef anchorToMove = g.anchorAtSide(item, side, orientation);
+        if (g.isFollowing(anchorToMove))
+            anchorToMove = g.endFollowee(anchorToMove);
+
+        const bool movingSide1 = side == AnchorData::Side1; // if true we're going to move left or top.
+        const int signess = movingSide1 ? 1 : -1;
+
+        // Note: Position can be slightly negative if the main window isn't big enougn to host the new size.
+        // In that case the window will be resized shortly after
+        setPosition(anchorToMove, g.position(anchorToMove) + (delta * signess));
+    }
+
+private:
+    // Returns the number of anchors in the shortest path from @p anchor (included) to a static
+    // anchor, going towards @p direction.
+    static int shortestLengthToStatic(const Graph &g, AnchorRef anchor, AnchorData::Side direction,
+                                      QHash<AnchorRef, int> &lengths)
+    {
+        if (g.isStatic(anchor))
+            return 0;
+
+        auto it = lengths.constFind(anchor);
+        if (it != lengths.cend())
+            return *it;
+
+        int shortest = 0;
+        const auto items = g.items(anchor, direction);
+        for (int i = 0, end = items.size(); i < end; ++i) {
+            const int length = shortestLengthToStatic(g, g.anchorAtSide(items[i], direction, g.orientation(anchor)), direction, lengths);
+            if (i == 0 || length < shortest)
+                shortest = length;
+        }
+
+        lengths.insert(anchor, shortest + 1);
+        return shortest + 1;
+    }
+
+    static CumulativeMin cumulativeMinLength_recursive(const Graph &g, AnchorRef anchor, AnchorData::Side side)
+    {
+        CumulativeMin result = { 0, 0 };
+        if (g.cachedCumulativeMinLength(anchor, side, result))
+            return result;
+
+        const Qt::Orientation orientation = g.orientation(anchor);
+        const auto items = g.items(anchor, side);
+        for (auto item : items) {
+            const AnchorRef oppositeAnchor = g.anchorAtSide(item, side, orientation);
+            if (!g.isValid(oppositeAnchor)) {
+                // Shouldn't happen. But don't assert as this might be being called from a dumpDebug()
+                qWarning() << Q_FUNC_INFO << "Null opposite anchor";
+                return { 0, 0 };
+            }
+
+            CumulativeMin candidateMin = { 0, 0 };
+            if (!g.isPlaceholder(item)) {
+                candidateMin.numItems++;
+                candidateMin.minLength = g.minLength(item, orientation);
+            }
+
+            candidateMin += cumulativeMinLength_recursive(g, oppositeAnchor, side);
+
+            if (candidateMin.minLength >= result.minLength)
+                result = candidateMin;
+        }
+
+        g.cacheCumulativeMinLength(anchor, side, result);
+        return result;
+    }
+};
+
+/**
+ * @brief Solves a LayoutModel, with the same LayoutMath as MultiSplitterLayout.
+ *
+ * Covers min size and anchor bounds calculation, moving an anchor, resizing the whole layout
+ * with space redistribution, and the anchor topology changes done when adding or removing items.
+ */
+class DOCKS_EXPORT_FOR_UNIT_TESTS LayoutSolver
+{
+public:
+    explicit LayoutSolver(const LayoutModel &model);
+
+    const LayoutModel &model() const { return m_model; }
+
+    ///@brief equivalent to Anchor::cumulativeMinLength()
+    int cumulativeMinLength(int anchor, AnchorData::Side side) const;
+
+    ///@brief equivalent to MultiSplitterLayout::minimumSize()
+    QSize minimumSize() const;
+
+    ///@brief equivalent to MultiSplitterLayout::boundPositionsForAnchor()
+    QPair<int, int> boundPositions(int anchor) const;
+
+    /**
+     * @brief Moves @p anchor to @p position, like dragging a separator does.
+     * @return false if the position is out of bounds, in which case nothing is changed
+     */
+    bool moveAnchor(int anchor, int position);
+
+    /**
+     * @brief Resizes the layout, redistributing the space according to each anchor's position
+     * percentage, like MultiSplitterLayout::setSize() does.
+     * @return false if @p size is smaller than the minimum size, in which case nothing is changed
+     */
+    bool resize(QSize size);
+
+    /**
+     * @brief Adds an item at @p location, like MultiSplitterLayout::addWidget() does with a Frame.
+     *
+     * @p relativeTo is the index of the item to add next to, or -1 to add at the layout's edge.
+     * @p preferredSize is the item's current size, the new item gets close to it if there's space.
+     * The layout grows if needed.
+     * @return the index of the new item, which is appended to LayoutModel::items, or -1 on invalid input
+     */
+    int addItem(QSize minSize, QSize preferredSize, Location location, int relativeTo = -1);
+
+    /**
+     * @brief Removes the item at index @p item, like MultiSplitterLayout::removeItem() does.
+     *
+     * Anchors left without items at one side are merged into the opposite anchor and removed.
+     * The indexes of the items and anchors after the removed ones shift down.
+     */
+    void removeItem(int item);
+
+    ///@brief equivalent to MultiSplitterLayout::ensureItemsMinSize()
+    void ensureItemsMinSize();
+
+private:
+    struct Graph;
+
+    void detach();
+    int length(Qt::Orientation) const;
+    int endFollowee(int anchor) const;
+    int minPosition(int anchor) const;
+    bool hasNonPlaceholderItems(int anchor, AnchorData::Side side) const;
+    bool hasVisibleItems() const;
+    int findNearestAnchorWithItems(int anchor, AnchorData::Side side) const;
+    int staticAnchor(AnchorData::Side side, Qt::Orientation orientation) const;
+    ItemData anchorGroup(int item) const;
+    DropLength lengthForDrop(QSize minSize, QSize preferredSize, Location location, int relativeTo) const;
+
+    void setAnchorPosition(int anchor, int position, bool dontRecalculatePercentage = false);
+    void updateItemGeometries(int anchor);
+    void positionStaticAnchors();
+    void ensureAnchorsBounded();
+    void updateSizeConstraints();
+    void ensureEnoughSize(QSize minSize, QSize preferredSize, Location location, int relativeTo);
+
+    // Topology changes, see Anchor and AnchorGroup
+    int createAnchorFrom(int other, int relativeTo, int from, int to);
+    void addItemToAnchor(int anchor, int item, AnchorData::Side side);
+    void removeItemFromAnchor(int anchor, int item);
+    void consume(int anchor, int other, AnchorData::Side side);
+    void deleteAnchor(int anchor);
+    void updateAnchorsFromTo(int oldAnchor, int newAnchor);
+    void setFollowee(int anchor, int followee);
+    void setThickness(int anchor);
+    void updateAnchorFollowing();
+    void compact(int removedItem);
+
+    LayoutModel m_model;
+    QVector<int> m_deadAnchors; // Deleted by compact(), so indexes don't change in the middle of an operation
+    bool m_addingItem = false;
+    bool m_resizing = false;
+    mutable QHash<QPair<int, int>, CumulativeMin> m_cumulativeMinLengthCache;
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LayoutStats_p.h"
+
+using namespace KDDockWidgets;
+
+void LayoutStats::record(Operation operation, qint64 nsecs)
+{
+    Counter &c = m_counters[operation];
+    c.count++;
+    c.totalNSecs += nsecs;
+    c.maxNSecs = qMax(c.maxNSecs, nsecs);
+}
+
+void LayoutStats::reset()
+{
+    for (Counter &c : m_counters)
+        c = Counter();
+}
+
+QString LayoutStats::operationName(Operation operation)
+{
+    switch (operation) {
+    case Operation_AddWidget:
+        return QStringLiteral("addWidget");
+    case Operation_RemoveItem:
+        return QStringLiteral("removeItem");
+    case Operation_RestorePlaceholder:
+        return QStringLiteral("restorePlaceholder");
+    case Operation_PropagateResize:
+        return QStringLiteral("propagateResize");
+    case Operation_RedistributeSpace:
+        return QStringLiteral("redistributeSpace");
+    case Operation_AnchorSetPosition:
+        return QStringLiteral("Anchor::setPosition");
+    case Operation_FrameGeometryUpdate:
+        return QStringLiteral("Frame geometry update");
+    case Operation_Count:
+        break;
+    }
+
+    return QString();
+}
+
+QString LayoutStats::toString() const
+{
+    QString result;
+    for (int i = 0; i < Operation_Count; ++i) {
+        const Counter &c = m_counters[i];
+        const double totalMs = c.totalNSecs / 1000000.0;
+        const double averageUs = c.count ? (c.totalNSecs / 1000.0) / c.count : 0.0;
+        result += QStringLiteral("%1: count=%2 total=%3ms avg=%4us max=%5us\n")
+                      .arg(operationName(Operation(i)))
+                      .arg(c.count)
+                      .arg(totalMs, 0, 'f', 3)
+                      .arg(averageUs, 0, 'f', 1)
+                      .arg(c.maxNSecs / 1000.0, 0, 'f', 1);
+    }
+
+    return result;
+}
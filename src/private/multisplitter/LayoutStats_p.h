@@ -0,0 +1,115 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @brief Per-layout counters and timings of the layout engine's operations.
+ *
+ * @author Sérgio Martins \<sergio.martins@kdab.com\>
+ */
+
+#ifndef KD_MULTISPLITTER_LAYOUTSTATS_P_H
+#define KD_MULTISPLITTER_LAYOUTSTATS_P_H
+
+#include "docks_export.h"
+
+#include <QElapsedTimer>
+#include <QString>
+
+namespace KDDockWidgets {
+
+/**
+ * @brief Counts and times the expensive operations of a MultiSplitterLayout.
+ *
+ * Unlike the logging categories this is always on, it costs a couple of clock reads per operation.
+ * Times are inclusive, for example addWidget()'s time includes the propagateResize() it triggers.
+ *
+ * @sa MultiSplitterLayout::stats()
+ */
+class DOCKS_EXPORT_FOR_UNIT_TESTS LayoutStats
+{
+public:
+    enum Operation {
+        Operation_AddWidget = 0,
+        Operation_RemoveItem,
+        Operation_RestorePlaceholder,
+        Operation_PropagateResize,
+        Operation_RedistributeSpace,
+        Operation_AnchorSetPosition,
+        Operation_FrameGeometryUpdate,
+        Operation_Count
+    };
+
+    struct Counter {
+        quint64 count = 0;
+        qint64 totalNSecs = 0;
+        qint64 maxNSecs = 0;
+    };
+
+    ///@brief Returns the counter for @p operation
+    const Counter &counter(Operation operation) const
+    {
+        return m_counters[operation];
+    }
+
+    ///@brief Accounts one call to @p operation, which took @p nsecs
+    void record(Operation operation, qint64 nsecs);
+
+    ///@brief Zeroes all counters
+    void reset();
+
+    ///@brief Returns the name of @p operation, for printing
+    static QString operationName(Operation operation);
+
+    ///@brief Returns a human readable table, one line per operation
+    QString toString() const;
+
+private:
+    Counter m_counters[Operation_Count];
+};
+
+/**
+ * @brief RAII helper that records the time spent in its scope as one call to an operation
+ */
+class LayoutStatsScope
+{
+public:
+    LayoutStatsScope(LayoutStats &stats, LayoutStats::Operation operation)
+        : m_stats(stats)
+        , m_operation(operation)
+    {
+        m_timer.start();
+    }
+
+    ~LayoutStatsScope()
+    {
+        m_stats.record(m_operation, m_timer.nsecsElapsed());
+    }
+
+private:
+    Q_DISABLE_COPY(LayoutStatsScope)
+    LayoutStats &m_stats;
+    const LayoutStats::Operation m_operation;
+    QElapsedTimer m_timer;
+};
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LazyResizePreview_p.h"
+
+#include <QPainter>
+#include <QRubberBand>
+#include <QStyleOption>
+
+using namespace KDDockWidgets;
+
+LazyResizePreview::LazyResizePreview(QWidget *multiSplitter)
+    : QWidget(multiSplitter)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    hide();
+}
+
+void LazyResizePreview::setRects(const QVector<QRect> &separatorRects, const QVector<QRect> &itemRects)
+{
+    m_separatorRects = separatorRects;
+    m_itemRects = itemRects;
+
+    setGeometry(parentWidget()->rect());
+    raise(); // Above the frames
+    update();
+}
+
+void LazyResizePreview::paintEvent(QPaintEvent *)
+{
+    // Same look as QRubberBand, but a single widget for everything
+    QPainter p(this);
+    QStyleOptionRubberBand opt;
+    opt.initFrom(this);
+    opt.opaque = false;
+
+    opt.shape = QRubberBand::Rectangle;
+    for (const QRect &rect : qAsConst(m_itemRects)) {
+        opt.rect = rect;
+        style()->drawControl(QStyle::CE_RubberBand, &opt, &p, this);
+    }
+
+    opt.shape = QRubberBand::Line;
+    opt.opaque = true;
+    for (const QRect &rect : qAsConst(m_separatorRects)) {
+        opt.rect = rect;
+        style()->drawControl(QStyle::CE_RubberBand, &opt, &p, this);
+    }
+}
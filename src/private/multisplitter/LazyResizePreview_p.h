@@ -0,0 +1,57 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KD_MULTISPLITTER_LAZYRESIZEPREVIEW_P_H
+#define KD_MULTISPLITTER_LAZYRESIZEPREVIEW_P_H
+
+#include <QWidget>
+#include <QVector>
+
+namespace KDDockWidgets {
+
+class MultiSplitter;
+
+/**
+ * @brief Overlay shown while dragging a separator with Config::Flag_LazyResize.
+ *
+ * Paints the separator at the position it's being dragged to and the rects the affected items
+ * will get once the mouse is released. Nothing is resized until then.
+ * There's a single instance per layout, created the first time a separator is dragged.
+ */
+class LazyResizePreview : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LazyResizePreview(QWidget *multiSplitter);
+
+    ///@brief Sets the rects to paint, in MultiSplitter coordinates
+    void setRects(const QVector<QRect> &separatorRects, const QVector<QRect> &itemRects);
+
+protected:
+    void paintEvent(QPaintEvent *) override;
+
+private:
+    QVector<QRect> m_separatorRects;
+    QVector<QRect> m_itemRects;
+};
+
+}
+
+#endif
@@ -33,15 +33,31 @@
 #include "MainWindowBase.h"
 #include "FloatingWindow_p.h"
 #include "LayoutSaver.h"
+#include "Config.h"
+#include "Anchor_p.h"
 
 #include <QScopedValueRollback>
 
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+# include <QMouseEvent>
+# include <QPainter>
+# include <QStyleOption>
+#endif
+
 using namespace KDDockWidgets;
 
 MultiSplitter::MultiSplitter(QWidgetOrQuick *parent)
     : QWidgetAdapter(parent)
     , m_layout(new MultiSplitterLayout(this))
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    , m_lightweightSeparators(Config::self().flags() & Config::Flag_LightweightSeparators)
+#endif
 {
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    if (m_lightweightSeparators)
+        setMouseTracking(true); // for the resize cursor when hovering a separator
+#endif
+
     connect(m_layout, &MultiSplitterLayout::minimumSizeChanged, this, [this] (QSize sz) {
         setMinimumSize(sz);
     });
@@ -77,12 +93,94 @@ bool MultiSplitter::onResize(QSize newSize)
 
     if (!LayoutSaver::restoreInProgress()) {
         // don't resize anything while we're restoring the layout
-        m_layout->setSize(newSize);
+        m_layout->requestSize(newSize);
     }
 
     return false; // So QWidget::resizeEvent is called
 }
 
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+void MultiSplitter::paintEvent(QPaintEvent *ev)
+{
+    if (!m_lightweightSeparators) {
+        QWidgetAdapter::paintEvent(ev);
+        return;
+    }
+
+    // Separators are the gaps between frames, paint them all in one go instead of having a widget each
+    QPainter p(this);
+    QStyleOption opt;
+    opt.palette = palette();
+    const QStyle::State baseState = isEnabled() ? QStyle::State_Enabled : QStyle::State_None;
+
+    for (Anchor *anchor : m_layout->anchors()) {
+        if (anchor->isFollowing() || !anchor->isVisible() || !ev->rect().intersects(anchor->geometry()))
+            continue;
+
+        opt.rect = anchor->geometry();
+        opt.state = baseState;
+        if (anchor->isVertical())
+            opt.state |= QStyle::State_Horizontal;
+
+        style()->drawControl(QStyle::CE_Splitter, &opt, &p, this);
+    }
+}
+
+void MultiSplitter::mousePressEvent(QMouseEvent *ev)
+{
+    if (m_lightweightSeparators && ev->button() == Qt::LeftButton) {
+        if (Anchor *anchor = m_layout->anchorAt(ev->pos())) {
+            anchor->onMousePress();
+            return;
+        }
+    }
+
+    QWidgetAdapter::mousePressEvent(ev);
+}
+
+void MultiSplitter::mouseMoveEvent(QMouseEvent *ev)
+{
+    if (m_lightweightSeparators) {
+        if (Anchor *anchor = m_layout->anchorBeingDragged()) {
+            anchor->onMouseMoved(ev->pos());
+            return;
+        }
+
+        updateSeparatorCursor(ev->pos());
+    }
+
+    QWidgetAdapter::mouseMoveEvent(ev);
+}
+
+void MultiSplitter::mouseReleaseEvent(QMouseEvent *ev)
+{
+    if (m_lightweightSeparators) {
+        if (Anchor *anchor = m_layout->anchorBeingDragged()) {
+            anchor->onMouseReleased();
+            updateSeparatorCursor(ev->pos());
+            return;
+        }
+    }
+
+    QWidgetAdapter::mouseReleaseEvent(ev);
+}
+
+void MultiSplitter::leaveEvent(QEvent *ev)
+{
+    if (m_lightweightSeparators && !m_layout->anchorIsBeingDragged())
+        unsetCursor();
+
+    QWidgetAdapter::leaveEvent(ev);
+}
+
+void MultiSplitter::updateSeparatorCursor(QPoint pos)
+{
+    if (Anchor *anchor = m_layout->anchorAt(pos))
+        setCursor(anchor->isVertical() ? Qt::SizeHorCursor : Qt::SizeVerCursor);
+    else
+        unsetCursor();
+}
+#endif
 
 bool MultiSplitter::isInMainWindow() const
 {
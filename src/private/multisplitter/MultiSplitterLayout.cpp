@@ -30,11 +30,16 @@
 #include "Separator_p.h"
 #include "FrameworkWidgetFactory.h"
 #include "LayoutSaver.h"
+#include "LazyResizePreview_p.h"
 
 #include <QAction>
 #include <QEvent>
 #include <QtMath>
 #include <QScopedValueRollback>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
 
 #define INDICATOR_MINIMUM_LENGTH 100
 #define KDDOCKWIDGETS_MIN_WIDTH 80
@@ -69,6 +74,8 @@ MultiSplitterLayout::MultiSplitterLayout(MultiSplitter *parent)
     connect(this, &MultiSplitterLayout::widgetCountChanged, this, [this] {
         Q_EMIT visibleWidgetCountChanged(visibleCount());
     });
+    connect(this, &MultiSplitterLayout::sizeChanged, this, &MultiSplitterLayout::invalidateSerializeCache);
+    connect(this, &MultiSplitterLayout::minimumSizeChanged, this, &MultiSplitterLayout::invalidateSerializeCache);
 
     m_leftAnchor->setObjectName(QStringLiteral("left"));
     m_rightAnchor->setObjectName(QStringLiteral("right"));
@@ -173,57 +180,12 @@ bool MultiSplitterLayout::validateInputs(QWidgetOrQuick *widget,
 
 std::pair<int,int> MultiSplitterLayout::boundInterval(int newPos1, Anchor* anchor1, int newPos2, Anchor *anchor2) const
 {
-    const int bound1 = boundPositionForAnchor(anchor1, Anchor::Side1);
-    const int bound2 = boundPositionForAnchor(anchor2, Anchor::Side2);
-
-    if (newPos1 >= bound1 && newPos2 <= bound2) {
-        // Simplest case, it's bounded.
-        return { newPos1, newPos2 };
-    }
-
-    if (newPos1 < bound1) {
-        // the anchor1 is out of bounds
-
-        const int bythismuch = bound1 - newPos1;
-        newPos1 = bound1;
-        newPos2 = newPos2 + bythismuch;
-
-        if (newPos2 > bound2) {
-            qWarning() << "Adjusted interval still out of bounds. Not enough space. #1"
-                       << "; newPos1=" << newPos1
-                       << "; newPos2=" << newPos2
-                       << "; bounds=" << bound1 << bound2
-                       << "; anchor1=" << anchor1
-                       << "; anchor2=" << anchor2
-                       << "; size=" << size();
-        }
-
-        return { newPos1, newPos2 };
-    } else if (newPos2 > bound2) {
-        // the anchor2 is out of bounds
-
-        const int bythismuch = newPos2 - bound2;
-        newPos2 = bound2;
-        newPos1 = newPos1 - bythismuch;
-
-        if (newPos1 < bound1) {
-            qWarning() << "Adjusted interval still out of bounds. Not enough space. #2"
-                       << "; newPos1=" << newPos1
-                       << "; newPos2=" << newPos2
-                       << "; bounds=" << bound1 << bound2
-                       << "; anchor1=" << anchor1
-                       << "; anchor2=" << anchor2
-                       << "; size=" << size();
-        }
-
-        return { newPos1, newPos2 };
-    }
-
-    return { newPos1, newPos2 };
+    return LayoutMath<LayoutGraph>::boundInterval(LayoutGraph(this), newPos1, anchor1, newPos2, anchor2);
 }
 
 void MultiSplitterLayout::addWidget(QWidgetOrQuick *w, Location location, Frame *relativeToWidget, AddingOption option)
 {
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_AddWidget);
     auto frame = qobject_cast<Frame*>(w);
     qCDebug(addwidget) << Q_FUNC_INFO << w
                        << "; location=" << locationStr(location)
@@ -234,6 +196,8 @@ void MultiSplitterLayout::addWidget(QWidgetOrQuick *w, Location location, Frame
                        << "; frame=" << frame
                        << "; option=" << option;
 
+    applyPendingSize();
+
     if (itemForFrame(frame) != nullptr) {
         // Item already exists, remove it.
         // Changing the frame parent will make the item clean itself up. It turns into a placeholder and is removed by unrefOldPlaceholders
@@ -247,6 +211,9 @@ void MultiSplitterLayout::addWidget(QWidgetOrQuick *w, Location location, Frame
 
     unrefOldPlaceholders(framesFrom(w));
 
+    // Anchors move several times while making room for the new widget, only resize the frames once
+    GeometryTransaction transaction(this);
+
     Item *relativeToItem = itemForFrame(relativeToWidget);
 
     ensureEnoughSize(w, location, relativeToItem);
@@ -402,6 +369,7 @@ void MultiSplitterLayout::addWidget(QWidgetOrQuick *w, Location location, Frame
 void MultiSplitterLayout::addItems_internal(const ItemList &items, bool updateConstraints, bool emitSignal)
 {
     m_items << items;
+    invalidateHitTestIndex();
     if (updateConstraints)
         updateSizeConstraints();
 
@@ -414,7 +382,32 @@ void MultiSplitterLayout::addItems_internal(const ItemList &items, bool updateCo
         }
     }
 
-    if (emitSignal)
+    if (emitSignal && m_addingBatchLevel == 0) // Otherwise endAddingBatch() emits
+        Q_EMIT widgetCountChanged(m_items.size());
+}
+
+void MultiSplitterLayout::beginAddingBatch()
+{
+    m_addingBatchLevel++;
+    beginGeometryTransaction();
+}
+
+void MultiSplitterLayout::endAddingBatch()
+{
+    if (m_addingBatchLevel <= 0) {
+        qWarning() << Q_FUNC_INFO << "No batch in progress";
+        return;
+    }
+
+    m_addingBatchLevel--;
+    if (m_addingBatchLevel == 0 && m_sizeConstraintsPending) {
+        // Before committing, as it can grow the layout
+        m_sizeConstraintsPending = false;
+        updateSizeConstraints();
+    }
+
+    commitGeometryTransaction();
+    if (m_addingBatchLevel == 0)
         Q_EMIT widgetCountChanged(m_items.size());
 }
 
@@ -483,23 +476,6 @@ void MultiSplitterLayout::ensureAnchorsBounded()
     ensureItemsMinSize();
 }
 
-static Anchor::List removeSmallestPath(QVector<Anchor::List> &paths)
-{
-    // Removes and returns the smallest list
-    Anchor::List smallestPath;
-    int indexOfSmallest = 0;
-    for (int i = 0, end = paths.size(); i < end; ++i) {
-        const Anchor::List &path = paths.at(i);
-        if (path.size() <= smallestPath.size() || smallestPath.isEmpty()) {
-            smallestPath = path;
-            indexOfSmallest = i;
-        }
-    }
-
-    paths.removeAt(indexOfSmallest);
-    return smallestPath;
-}
-
 void MultiSplitterLayout::propagateResize(int delta, Anchor *fromAnchor, Anchor::Side direction)
 {
     if (delta < 0)
@@ -508,78 +484,12 @@ void MultiSplitterLayout::propagateResize(int delta, Anchor *fromAnchor, Anchor:
     if (delta <= 0 || fromAnchor->isStatic())
         return;
 
-    QVector<Anchor::List> paths;
-    collectPaths(paths, fromAnchor, direction);
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_PropagateResize);
 
-    for (const Anchor::List &path : qAsConst(paths)) {
-        qCDebug(sizing) << Q_FUNC_INFO << path;
-    }
-
-    Anchor::List anchorsThatAlreadyContributed;
-    anchorsThatAlreadyContributed.push_back(fromAnchor);
-
-    while (!paths.isEmpty()) {
-        // Get smallest path:
-        Anchor::List smallestPath = removeSmallestPath(/*by-ref*/paths);
-        if (smallestPath.size() <= 1) {
-            // Nothing to do, it has a single anchor, which was already adjusted in addWidget()
-            continue;
-        }
-
-        const bool towardsSide1 = direction == Anchor::Side1;
-        const bool towardsSide2 = !towardsSide1;
-
-        const int sign = towardsSide1 ? -1 : 1;
-        const int contributionPerAnchor = (delta / (smallestPath.size() - 1)) * sign; // n-1 because the initial anchor already contributed
-        if (qAbs(contributionPerAnchor) < 5) {
-            // Too small, don't bother
-            continue;
-        }
-
-        // Now make those anchors contribute, skipping the first
-        for (int i = 1, end = smallestPath.size(); i < end; ++i) {
-            Anchor *a = smallestPath.at(i);
-            if (!anchorsThatAlreadyContributed.contains(a)) {
-                // When moving anchors don't allow widgets to go bellow their min size
-                const int bound = boundPositionForAnchor(a, direction);
-                int newPosition = a->position() + contributionPerAnchor;
-                if ((towardsSide1 && newPosition < bound) ||
-                    (towardsSide2 && newPosition > bound)) {
-                    newPosition = bound;
-                }
-
-                if (a->position() != newPosition) {
-                    a->setPosition(newPosition);
-                    anchorsThatAlreadyContributed.push_back(a);
-                }
-            }
-        }
-    }
-}
-
-void MultiSplitterLayout::collectPaths(QVector<Anchor::List> &paths, Anchor *fromAnchor, Anchor::Side direction)
-{
-    if (fromAnchor->isStatic()) {
-        // We've finally reached a border anchor, we can stop now.
-        return;
-    }
-
-    if (paths.isEmpty())
-        paths.push_back({});
-
-    int currentPathIndex = paths.size() - 1; // Store the index instead of using "Anchor::List &currentPath = paths.last();" as the references are stable, as the paths vector reallocates
-
-    paths[currentPathIndex].push_back(fromAnchor);
-
-    const ItemList items = fromAnchor->items(direction);
-    for (int i = 0, end = items.size(); i < end; ++i) {
-        Anchor *nextAnchor = items[i]->anchorAtSide(direction, fromAnchor->orientation());
-        if (i > 0) {
-            Anchor::List newPath = paths[currentPathIndex];
-            paths.push_back(newPath);
-        }
-        collectPaths(paths, nextAnchor, direction);
-    }
+    LayoutMath<LayoutGraph>::propagateResize(LayoutGraph(this), delta, fromAnchor, AnchorData::Side(direction), [] (Anchor *anchor, int position) {
+        qCDebug(sizing) << "MultiSplitterLayout::propagateResize" << anchor << "; newPosition=" << position;
+        anchor->setPosition(position);
+    });
 }
 
 void MultiSplitterLayout::resizeItem(Frame *frame, int newSize, Qt::Orientation orientation)
@@ -630,6 +540,8 @@ void MultiSplitterLayout::removeItem(Item *item)
     if (!item || m_inDestructor || !m_items.contains(item))
         return;
 
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_RemoveItem);
+
     maybeCheckSanity();
 
     if (!item->isPlaceholder())
@@ -637,6 +549,8 @@ void MultiSplitterLayout::removeItem(Item *item)
     AnchorGroup anchorGroup = item->anchorGroup();
     anchorGroup.removeItem(item);
     m_items.removeOne(item);
+    invalidateCumulativeMinLengthCache();
+    invalidateHitTestIndex();
 
     updateAnchorFollowing();
 
@@ -656,7 +570,13 @@ bool MultiSplitterLayout::contains(const Frame *frame) const
 
 Item *MultiSplitterLayout::itemAt(QPoint p) const
 {
-    for (Item *item : m_items) {
+    ensureHitTestIndex();
+    if (!m_hitTestBounds.contains(p))
+        return nullptr;
+
+    const int column = (p.x() - m_hitTestBounds.x()) / m_hitTestCellSize.width();
+    const int row = (p.y() - m_hitTestBounds.y()) / m_hitTestCellSize.height();
+    for (Item *item : m_hitTestGrid.at(row * m_hitTestColumns + column)) {
         if (!item->isPlaceholder() && item->geometry().contains(p))
             return item;
     }
@@ -664,12 +584,72 @@ Item *MultiSplitterLayout::itemAt(QPoint p) const
     return nullptr;
 }
 
+Anchor *MultiSplitterLayout::anchorAt(QPoint p) const
+{
+    for (Anchor *anchor : m_anchors) {
+        if (!anchor->isStatic() && !anchor->isFollowing() && anchor->isVisible() && anchor->geometry().contains(p))
+            return anchor;
+    }
+
+    return nullptr;
+}
+
+void MultiSplitterLayout::invalidateHitTestIndex()
+{
+    m_hitTestIndexDirty = true;
+    // rectForDrop() and serialize() depend on the same geometry
+    invalidateRectForDropCache();
+    invalidateSerializeCache();
+}
+
+void MultiSplitterLayout::ensureHitTestIndex() const
+{
+    if (!m_hitTestIndexDirty)
+        return;
+
+    m_hitTestIndexDirty = false;
+    m_hitTestGrid.clear();
+    m_hitTestBounds = QRect();
+
+    // Placeholders are indexed too, as they can become visible without changing geometry
+    for (Item *item : m_items)
+        m_hitTestBounds |= item->geometry();
+
+    if (m_hitTestBounds.isEmpty()) {
+        m_hitTestColumns = 0;
+        return;
+    }
+
+    // Items don't overlap, so with ~sqrt(N) x ~sqrt(N) cells each cell only has a few of them
+    const int side = qBound(1, qCeil(qSqrt(m_items.size())), 64);
+    m_hitTestColumns = side;
+    m_hitTestCellSize = QSize((m_hitTestBounds.width() + side - 1) / side,
+                              (m_hitTestBounds.height() + side - 1) / side);
+    m_hitTestGrid.resize(side * side);
+
+    for (Item *item : m_items) {
+        const QRect geo = item->geometry().intersected(m_hitTestBounds);
+        if (geo.isEmpty())
+            continue;
+
+        const int firstColumn = (geo.left() - m_hitTestBounds.x()) / m_hitTestCellSize.width();
+        const int lastColumn = (geo.right() - m_hitTestBounds.x()) / m_hitTestCellSize.width();
+        const int firstRow = (geo.top() - m_hitTestBounds.y()) / m_hitTestCellSize.height();
+        const int lastRow = (geo.bottom() - m_hitTestBounds.y()) / m_hitTestCellSize.height();
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column)
+                m_hitTestGrid[row * side + column].push_back(item);
+        }
+    }
+}
+
 void MultiSplitterLayout::clear(bool alsoDeleteStaticAnchors)
 {
     const int oldCount = count();
     const int oldVisibleCount = visibleCount();
     const auto items = m_items;
     m_items.clear(); // Clear the item list first, do avoid ~Item() triggering a removal from the list
+    invalidateHitTestIndex();
     qDeleteAll(items);
 
     const auto anchors = m_anchors;
@@ -696,6 +676,8 @@ void MultiSplitterLayout::clear(bool alsoDeleteStaticAnchors)
         m_anchors = { m_topAnchor, m_bottomAnchor, m_leftAnchor, m_rightAnchor };
     }
 
+    invalidateCumulativeMinLengthCache();
+
     if (oldCount > 0)
         Q_EMIT widgetCountChanged(0);
     if (oldVisibleCount > 0)
@@ -717,50 +699,340 @@ int MultiSplitterLayout::placeholderCount() const
     return count() - visibleCount();
 }
 
+int MultiSplitterLayout::compactPlaceholders()
+{
+    const int budget = Config::self().maxPlaceholdersPerLayout();
+    if (budget < 0 || m_inDestructor || LayoutSaver::restoreInProgress())
+        return 0;
+
+    ItemList placeholders;
+    for (Item *item : qAsConst(m_items)) {
+        if (item->isPlaceholder())
+            placeholders.push_back(item);
+    }
+
+    if (placeholders.size() <= budget)
+        return 0;
+
+    std::sort(placeholders.begin(), placeholders.end(), [] (Item *a, Item *b) {
+        return a->placeholderSerial() < b->placeholderSerial();
+    });
+
+    QVector<QPointer<Item>> unneeded;
+    const int numUnneeded = placeholders.size() - budget;
+    unneeded.reserve(numUnneeded);
+    for (int i = 0; i < numUnneeded; ++i)
+        unneeded.push_back(placeholders.at(i));
+
+    // The LastPositions are what keep a placeholder alive. Once the last ref is gone the Item
+    // deletes itself, which removes it from the layout and merges the anchors it leaves unneeded.
+    int removed = 0;
+    for (const QPointer<Item> &item : qAsConst(unneeded)) {
+        if (!item || !item->isPlaceholder())
+            continue;
+
+        const QVector<LastPosition*> lastPositions = item->lastPositions();
+        for (LastPosition *lastPosition : lastPositions) {
+            lastPosition->removePlaceholder(item);
+            if (!item)
+                break;
+        }
+
+        if (item) {
+            qWarning() << Q_FUNC_INFO << "Placeholder still referenced" << item << item->refCount();
+        } else {
+            removed++;
+        }
+    }
+
+    qCDebug(placeholder) << Q_FUNC_INFO << "removed" << removed << "placeholders; count=" << count();
+    maybeCheckSanity();
+    return removed;
+}
+
+void MultiSplitterLayout::showLazyResizePreview(Anchor *anchor, int pos)
+{
+    auto moveTo = [pos] (QRect geo, Qt::Orientation orientation) {
+        if (orientation == Qt::Vertical)
+            geo.moveLeft(pos);
+        else
+            geo.moveTop(pos);
+        return geo;
+    };
+
+    // Anchors following the dragged one move with it, so their items are affected too
+    QHash<Item*, QRect> itemRects;
+    Anchor::List moving = { anchor };
+    for (int i = 0; i < moving.size(); ++i) {
+        Anchor *a = moving.at(i);
+        moving += anchorsFollowing(a);
+        const QRect separatorGeo = moveTo(a->geometry(), a->orientation());
+
+        for (Item *item : a->items(Anchor::Side1)) {
+            if (item->isPlaceholder())
+                continue;
+            QRect &geo = itemRects[item];
+            if (geo.isNull())
+                geo = item->geometry();
+            if (a->isVertical())
+                geo.setRight(separatorGeo.left() - 1);
+            else
+                geo.setBottom(separatorGeo.top() - 1);
+        }
+
+        for (Item *item : a->items(Anchor::Side2)) {
+            if (item->isPlaceholder())
+                continue;
+            QRect &geo = itemRects[item];
+            if (geo.isNull())
+                geo = item->geometry();
+            if (a->isVertical())
+                geo.setLeft(separatorGeo.left() + a->thickness());
+            else
+                geo.setTop(separatorGeo.top() + a->thickness());
+        }
+    }
+
+    if (!m_lazyResizePreview)
+        m_lazyResizePreview = new LazyResizePreview(m_multiSplitter);
+
+    m_lazyResizePreview->setRects({ moveTo(anchor->geometry(), anchor->orientation()) }, itemRects.values().toVector());
+    m_lazyResizePreview->show();
+}
+
+void MultiSplitterLayout::hideLazyResizePreview()
+{
+    if (m_lazyResizePreview)
+        m_lazyResizePreview->hide();
+}
+
+void MultiSplitterLayout::scheduleCompactPlaceholders()
+{
+    const int budget = Config::self().maxPlaceholdersPerLayout();
+    if (budget < 0 || m_compactPlaceholdersPending || m_inDestructor)
+        return;
+
+    // Deferred, as we're usually called from within a layout operation
+    m_compactPlaceholdersPending = true;
+    QTimer::singleShot(0, this, [this] {
+        m_compactPlaceholdersPending = false;
+        if (placeholderCount() > Config::self().maxPlaceholdersPerLayout())
+            compactPlaceholders();
+    });
+}
+
 void MultiSplitterLayout::removeAnchor(Anchor *anchor)
 {
     if (!m_inDestructor)
         m_anchors.removeOne(anchor);
+
+    invalidateCumulativeMinLengthCache();
 }
 
-QPair<int, int> MultiSplitterLayout::boundPositionsForAnchor(Anchor *anchor) const
+void MultiSplitterLayout::invalidateCumulativeMinLengthCache()
+{
+    m_cumulativeMinLengthCache.clear();
+    invalidateRectForDropCache();
+    invalidateSerializeCache();
+}
+
+void MultiSplitterLayout::invalidateCumulativeMinLengthCache(Item *item, Qt::Orientations orientations)
 {
-    if (anchor->isStatic()) {
-        if (anchor == m_leftAnchor || anchor == m_topAnchor) {
-            return {0, 0};
-        } else if (anchor == m_rightAnchor || anchor == m_bottomAnchor) {
-            const int max = length(anchor->orientation()) - Anchor::thickness(true);
-            return {max, max};
+    if (!item->anchorGroup().isValid() || m_addingBatchLevel > 0) {
+        // Not in the anchor graph yet, adding it will clear everything anyway.
+        // Same while adding a batch, each insertion changes the topology and clears everything.
+        invalidateCumulativeMinLengthCache();
+        return;
+    }
+
+    QSet<Anchor*> visited;
+    for (Qt::Orientation orientation : { Qt::Vertical, Qt::Horizontal }) {
+        if (orientations & orientation) {
+            invalidateCumulativeMinLength_recursive(item->anchorAtSide(Anchor::Side1, orientation), Anchor::Side2, visited);
+            visited.clear();
+            invalidateCumulativeMinLength_recursive(item->anchorAtSide(Anchor::Side2, orientation), Anchor::Side1, visited);
+            visited.clear();
         }
     }
 
-    if (anchor->isFollowing())
-        anchor = anchor->endFollowee();
+    invalidateRectForDropCache();
+    invalidateSerializeCache();
+}
 
-    const int minSide1Length = anchor->cumulativeMinLength(Anchor::Side1);
-    const int minSide2Length = anchor->cumulativeMinLength(Anchor::Side2);
-    const int length = anchor->isVertical() ? width() : height();
+void MultiSplitterLayout::invalidateCumulativeMinLength_recursive(Anchor *anchor, Anchor::Side side,
+                                                                  QSet<Anchor*> &visited)
+{
+    if (!anchor || visited.contains(anchor))
+        return;
 
-    const int bound1 = qMax(0, minSide1Length - anchor->thickness());
-    const int bound2 = qMax(0, length - minSide2Length);
+    visited.insert(anchor);
+    m_cumulativeMinLengthCache.remove(qMakePair<const Anchor*, int>(anchor, int(side)));
+
+    // The result for (anchor, side) depends on the items at that side, so walk in the opposite direction
+    const Anchor::Side oppositeSide = side == Anchor::Side1 ? Anchor::Side2 : Anchor::Side1;
+    for (Item *item : anchor->items(oppositeSide))
+        invalidateCumulativeMinLength_recursive(item->anchorAtSide(oppositeSide, anchor->orientation()), side, visited);
+}
+
+/// LayoutMath's view of the live anchors and items
+struct MultiSplitterLayout::LayoutGraph
+{
+    typedef Anchor *AnchorRef;
+    typedef Item *ItemRef;
+
+    explicit LayoutGraph(const MultiSplitterLayout *layout)
+        : q(layout)
+    {
+    }
+
+    bool isValid(Anchor *a) const { return a != nullptr; }
+    Qt::Orientation orientation(Anchor *a) const { return a->orientation(); }
+    ItemList items(Anchor *a, AnchorData::Side side) const { return a->items(Anchor::Side(side)); }
+    Anchor *anchorAtSide(Item *item, AnchorData::Side side, Qt::Orientation o) const { return item->anchorAtSide(Anchor::Side(side), o); }
+    bool isPlaceholder(Item *item) const { return item->isPlaceholder(); }
+    int minLength(Item *item, Qt::Orientation o) const { return item->minLength(o); }
+    int itemLength(Item *item, Qt::Orientation o) const { return item->length(o); }
+    bool isStatic(Anchor *a) const { return a->isStatic(); }
+    bool isEmpty(Anchor *a) const { return a->isEmpty(); }
+    bool isLeftOrTopStatic(Anchor *a) const { return a->type() & (Anchor::Type_LeftStatic | Anchor::Type_TopStatic); }
+    bool isRightOrBottomStatic(Anchor *a) const { return a->type() & (Anchor::Type_RightStatic | Anchor::Type_BottomStatic); }
+    bool isFollowing(Anchor *a) const { return a->isFollowing(); }
+    Anchor *endFollowee(Anchor *a) const { return a->endFollowee(); }
+    int staticAnchorThickness() const { return Anchor::thickness(true); }
+    int anchorThickness() const { return Anchor::thickness(false); }
+    int defaultThickness(Anchor *a) const { return Anchor::thickness(a->isStatic()); }
+    int thickness(Anchor *a) const { return a->thickness(); }
+    int position(Anchor *a) const { return a->position(); }
+    int length(Qt::Orientation o) const { return q->length(o); }
+    bool hasNonPlaceholderItems(Anchor *a, AnchorData::Side side) const { return a->hasNonPlaceholderItems(Anchor::Side(side)); }
+    int minPosition(Anchor *a) const { return a->minPosition(); }
+    qreal positionPercentage(Anchor *a) const { return a->positionPercentage(); }
+
+    bool cachedCumulativeMinLength(Anchor *a, AnchorData::Side side, CumulativeMin &result) const
+    {
+        auto it = q->m_cumulativeMinLengthCache.constFind(qMakePair<const Anchor*, int>(a, int(side)));
+        if (it == q->m_cumulativeMinLengthCache.cend())
+            return false;
+
+        result = *it;
+        return true;
+    }
+
+    void cacheCumulativeMinLength(Anchor *a, AnchorData::Side side, CumulativeMin result) const
+    {
+        q->m_cumulativeMinLengthCache.insert(qMakePair<const Anchor*, int>(a, int(side)), result);
+    }
+
+    const MultiSplitterLayout *const q;
+};
+
+int MultiSplitterLayout::cumulativeMinLength(Anchor *anchor, Anchor::Side side) const
+{
+    return LayoutMath<LayoutGraph>::cumulativeMinLength(LayoutGraph(this), anchor, AnchorData::Side(side));
+}
+
+void MultiSplitterLayout::ensureMinSize(Item *item, Qt::Orientation orientation)
+{
+    LayoutMath<LayoutGraph>::ensureMinSize(LayoutGraph(this), item, orientation, [] (Anchor *anchor, int position) {
+        anchor->setPosition(position);
+    });
+}
+
+void MultiSplitterLayout::ensureMinSize(Item *item, Qt::Orientation orientation, Anchor::Side side)
+{
+    LayoutMath<LayoutGraph>::ensureMinSize(LayoutGraph(this), item, orientation, AnchorData::Side(side), [item] (Anchor *anchor, int position) {
+        // When dropping a MultiSplitter into a MultiSplitter there's an instant where some anchors of the group are from the source MultiSplitter, as they weren't consumed yet.
+        if (anchor->parent() == item->parentWidget())
+            anchor->setPosition(position);
+    });
+}
+
+void MultiSplitterLayout::setRectForDropCacheEnabled(bool enabled)
+{
+    m_rectForDropCacheEnabled = enabled;
+    if (!enabled)
+        invalidateRectForDropCache();
+}
+
+void MultiSplitterLayout::invalidateRectForDropCache()
+{
+    m_rectForDropCache.clear();
+}
+
+void MultiSplitterLayout::invalidateSerializeCache()
+{
+    m_serializeCacheDirty = true;
+}
+
+const LayoutStats &MultiSplitterLayout::stats() const
+{
+    return m_stats;
+}
+
+void MultiSplitterLayout::resetStats()
+{
+    m_stats.reset();
+}
+
+void MultiSplitterLayout::beginGeometryTransaction()
+{
+    m_geometryTransactionLevel++;
+}
+
+void MultiSplitterLayout::commitGeometryTransaction()
+{
+    if (m_geometryTransactionLevel <= 0) {
+        qWarning() << Q_FUNC_INFO << "No geometry transaction in progress";
+        return;
+    }
+
+    if (--m_geometryTransactionLevel > 0)
+        return; // Only the outermost transaction applies the geometries
+
+    const QVector<QPointer<Item>> pendingItems = std::move(m_pendingGeometryItems);
+    m_pendingGeometryItems.clear();
+
+    for (const QPointer<Item> &item : pendingItems) {
+        if (item) // Might have been deleted meanwhile
+            item->applyPendingGeometry();
+    }
+
+    if (!pendingItems.isEmpty())
+        invalidateSerializeCache(); // The frame geometries are saved too
+
+    maybeCheckSanity();
+}
+
+void MultiSplitterLayout::scheduleGeometryUpdate(Item *item)
+{
+    Q_ASSERT(isInGeometryTransaction());
+    m_pendingGeometryItems.push_back(item);
+}
+
+QPair<int, int> MultiSplitterLayout::boundPositionsForAnchor(Anchor *anchor) const
+{
+    const QPair<int, int> bounds = LayoutMath<LayoutGraph>::boundPositions(LayoutGraph(this), anchor);
+
+    if (bounds.second < bounds.first) {
+        if (anchor->isFollowing())
+            anchor = anchor->endFollowee();
 
-    if (bound2 < bound1) {
         qWarning() << Q_FUNC_INFO << "Invalid bounds"
-                   << "; bound1=" << bound1
-                   << "; bound2=" << bound2
+                   << "; bound1=" << bounds.first
+                   << "; bound2=" << bounds.second
                    << "; layout.size=" << size()
                    << "; layout.min=" << minimumSize()
                    << "; anchor=" << anchor
                    << "; orientation=" << anchor->orientation()
-                   << "; minSide1Length=" << minSide1Length
-                   << "; minSide2Length=" << minSide2Length
+                   << "; minSide1Length=" << anchor->cumulativeMinLength(Anchor::Side1)
+                   << "; minSide2Length=" << anchor->cumulativeMinLength(Anchor::Side2)
                    << "; side1=" << anchor->side1Items()
                    << "; side2=" << anchor->side2Items()
                    << "; followee=" << anchor->followee()
                    << "; thickness=" << anchor->thickness();
     }
 
-    return { bound1, bound2 };
+    return bounds;
 }
 
 QHash<Anchor *, QPair<int, int> > MultiSplitterLayout::boundPositionsForAllAnchors() const
@@ -781,69 +1053,24 @@ int MultiSplitterLayout::boundPositionForAnchor(Anchor *anchor, Anchor::Side dir
 
 MultiSplitterLayout::Length MultiSplitterLayout::availableLengthForDrop(Location location, const Item *relativeTo) const
 {
-    Length result;
-
     const bool relativeToThis = relativeTo == nullptr;
 
     AnchorGroup anchors = relativeToThis ? staticAnchorGroup()
                                          : relativeTo->anchorGroup();
 
-    Anchor *anchor = nullptr;
-
-    int thisLength = 0;
-
-    switch (location) {
-    case KDDockWidgets::Location_None:
+    if (location == KDDockWidgets::Location_None) {
         qWarning() << "MultiSplitterLayout::availableLengthForDrop invalid location for dropping";
-        return result;
-    case KDDockWidgets::Location_OnLeft:
-        anchor = anchors.left;
-        thisLength = width();
-        break;
-    case KDDockWidgets::Location_OnTop:
-        anchor = anchors.top;
-        thisLength = height();
-        break;
-    case KDDockWidgets::Location_OnRight:
-        anchor = anchors.right;
-        thisLength = width();
-        break;
-    case KDDockWidgets::Location_OnBottom:
-        anchor = anchors.bottom;
-        thisLength = height();
-        break;
+        return {};
     }
 
-    anchor = anchor->isFollowing() ? anchor->endFollowee() : anchor;
-
-    const int minForAlreadyOccupied1 = anchor->cumulativeMinLength(Anchor::Side1) - anchor->thickness(); // TODO: Check if this is correct, we're discounting the anchor twice
-    const int minForAlreadyOccupied2 = anchor->cumulativeMinLength(Anchor::Side2) - anchor->thickness();
-
-    const int side1AvailableLength = anchor->position() - minForAlreadyOccupied1;
-    const int side2AvailableLength = thisLength - (anchor->position() + anchor->thickness()) - minForAlreadyOccupied2;
-
-    const bool needsNewAnchor = hasVisibleItems(); // If a new anchor is needed then we need space for the drag handle and such.
-    const int newAnchorThickness = needsNewAnchor ? Anchor::thickness(/*static=*/false) : 0;
-
-    // This useless space doesn't belong to side1 or side2 specifically. So account for it separately.
-    const int unusableSpace = newAnchorThickness;
-
-    const int usableLength = qMax(0, side1AvailableLength + side2AvailableLength - unusableSpace);
-    if (usableLength > 0) {
-        qreal factor = (side1AvailableLength * 1.0) / (side1AvailableLength + side2AvailableLength);
-        result.side1Length = int(qRound(usableLength * factor)); // rounding not really needed, but makes things more fair probably
-        result.side2Length = usableLength - result.side1Length;
-    }
+    // If a new anchor is needed then we need space for the drag handle and such.
+    const Length result = LayoutMath<LayoutGraph>::availableLengthForDrop(LayoutGraph(this), anchors.anchor(location),
+                                                                          /*needsNewAnchor=*/ hasVisibleItems());
 
     qCDebug(sizing) << Q_FUNC_INFO
                     << "; available=" << result.length() << result.side1Length << result.side2Length
-                    << "; side1AvailableLength=" << side1AvailableLength
-                    << "; side2AvailableLength=" << side2AvailableLength
-                    << "; minForAlreadyOccupied1=" << minForAlreadyOccupied1
-                    << "; minForAlreadyOccupied2=" << minForAlreadyOccupied2
-                    << "; thisLength=" << thisLength
-                    << "; anchorPos=" << anchor->position()
-                    << "; unusableSpace=" << unusableSpace;
+                    << "; location=" << location
+                    << "; relativeTo=" << relativeTo;
 
     return result;
 }
@@ -871,20 +1098,16 @@ MultiSplitterLayout::Length MultiSplitterLayout::lengthForDrop(const QWidgetOrQu
 
     const Qt::Orientation anchorOrientation = anchorOrientationForLocation(location);
     const int widgetCurrentLength = widgetLength(widget, anchorOrientation);
-    Length available = availableLengthForDrop(location, relativeTo);
-
     const int requiredAtLeast = widgetMinLength(widget, anchorOrientation);
-    if (available.length() < requiredAtLeast) {
+    const Length available = LayoutMath<LayoutGraph>::lengthForDrop(LayoutGraph(this), availableLengthForDrop(location, relativeTo),
+                                                                    anchorOrientation, requiredAtLeast, widgetCurrentLength);
+    if (available.isNull()) {
         qCDebug(sizing) << Q_FUNC_INFO
-                        << "\n    Not enough space. available=" << available.length()
-                        << "; required=" << requiredAtLeast
+                        << "\n    Not enough space. required=" << requiredAtLeast
                         << "; m_size=" << m_size;
         return {};
     }
 
-    const int suggestedLength = qMin(widgetCurrentLength, int(0.4 * length(anchorOrientation)));
-    available.setLength(qBound(requiredAtLeast, suggestedLength, available.length()));
-
     qCDebug(sizing) << "MultiSplitterLayout::lengthForDrop length=" << available.length()
                     << "; s1=" << available.side1Length << "; s2="<< available.side2Length
                     << "; relativeTo=" << relativeTo
@@ -895,38 +1118,13 @@ MultiSplitterLayout::Length MultiSplitterLayout::lengthForDrop(const QWidgetOrQu
 
 QRect MultiSplitterLayout::rectForDrop(MultiSplitterLayout::Length lfd, Location location, QRect relativeToRect) const
 {
-    QRect result;
-    const int widgetLength = lfd.length();
-    const int newAnchorThickness = isEmpty() ? 0 : Anchor::thickness(/*static=*/false);
-    const int side1Length = lfd.side1Length;
-    const int staticAnchorThickness = Anchor::thickness(/**static=*/true);
-
-    switch (location) {
-    case Location_OnLeft:
-        result = QRect(qMax(0, relativeToRect.x() - side1Length), relativeToRect.y(),
-                       widgetLength, relativeToRect.height());
-        break;
-    case Location_OnTop:
-        result = QRect(relativeToRect.x(), qMax(0, relativeToRect.y() - side1Length),
-                       relativeToRect.width(), widgetLength);
-        break;
-    case Location_OnRight:
-        result = QRect(qMin(relativeToRect.right() + 1 - side1Length + newAnchorThickness,
-                            width() - widgetLength - staticAnchorThickness), relativeToRect.y(), widgetLength, relativeToRect.height());
-        break;
-    case Location_OnBottom:
-        result = QRect(relativeToRect.x(), qMin(relativeToRect.bottom() + 1 - side1Length + newAnchorThickness,
-                                                height() - widgetLength - staticAnchorThickness),
-                       relativeToRect.width(), widgetLength);
-        break;
-    default:
-        break;
-    }
+    const QRect result = LayoutMath<LayoutGraph>::rectForDrop(LayoutGraph(this), lfd, location, relativeToRect,
+                                                              /*needsNewAnchor=*/ !isEmpty());
 
     qCDebug(sizing) << "MultiSplitterLayout::rectForDrop rect=" << result
                     << "; result.bottomRight=" << result.bottomRight()
                     << "; location=" << location
-                    << "; s1=" << side1Length
+                    << "; s1=" << lfd.side1Length
                     << "; relativeToRect.bottomRight=" << relativeToRect.bottomRight();
     return result;
 }
@@ -935,6 +1133,15 @@ QRect MultiSplitterLayout::rectForDrop(const QWidgetOrQuick *widgetBeingDropped,
                                        const Item *relativeTo) const
 {
     Q_ASSERT(widgetBeingDropped);
+
+    const bool useCache = m_rectForDropCacheEnabled;
+    const auto cacheKey = qMakePair(relativeTo, int(location));
+    if (useCache) {
+        auto it = m_rectForDropCache.constFind(cacheKey);
+        if (it != m_rectForDropCache.cend() && it->widgetSize == widgetBeingDropped->size())
+            return it->rect;
+    }
+
     Length lfd = lengthForDrop(widgetBeingDropped, location, relativeTo);
     const bool needsMoreSpace = lfd.isNull();
     if (needsMoreSpace)  {
@@ -953,11 +1160,19 @@ QRect MultiSplitterLayout::rectForDrop(const QWidgetOrQuick *widgetBeingDropped,
     // This function is split in two just so we can unit-test the math in the second one, which is more involved
     QRect result = rectForDrop(lfd, location, relativeToRect);
 
+    if (useCache)
+        m_rectForDropCache.insert(cacheKey, { widgetBeingDropped->size(), result });
+
     return result;
 }
 
 void MultiSplitterLayout::setAnchorBeingDragged(Anchor *anchor)
 {
+    if (anchor)
+        applyPendingSize(); // The bounds are calculated from the current size
+    else
+        hideLazyResizePreview();
+
     m_anchorBeingDragged = anchor;
 }
 
@@ -991,7 +1206,7 @@ int MultiSplitterLayout::numVisibleAnchors() const
 {
     int count = 0;
     for (Anchor *a : m_anchors) {
-        if (a->separatorWidget()->isVisible())
+        if (a->isVisible())
             count++;
     }
 
@@ -1060,15 +1275,17 @@ void MultiSplitterLayout::dumpDebug() const
         auto side1Widgets = anchor->items(Anchor::Side1);
         auto side2Widgets = anchor->items(Anchor::Side2);
         auto bounds = anchor->isStatic() ? QPair<int, int>() : boundPositionsForAnchor(anchor);
+        Separator *separator = anchor->separatorWidget();
+        const QRect separatorGeometry = separator ? separator->geometry() : anchor->geometry();
         qDebug() << "\n    " << anchor
                  << "; side1=" << side1Widgets
                  << "; side2=" << side2Widgets
                  << "; pos=" << anchor->position()
-                 << "; sepWidget.pos=" << (anchor->isVertical() ? anchor->separatorWidget()->x()
-                                                                : anchor->separatorWidget()->y())
-                 << "; sepWidget.visible=" << anchor->separatorWidget()->isVisible()
+                 << "; sepWidget.pos=" << (anchor->isVertical() ? separatorGeometry.x()
+                                                                : separatorGeometry.y())
+                 << "; sepWidget.visible=" << anchor->isVisible()
                  << "; geo=" << anchor->geometry()
-                 << "; sep.geo=" << anchor->separatorWidget()->geometry()
+                 << "; sep.geo=" << separatorGeometry
                  << "; bounds=" << bounds
                  << "; orientation=" << anchor->orientation()
                  << "; isFollowing=" << anchor->isFollowing()
@@ -1093,6 +1310,7 @@ void MultiSplitterLayout::positionStaticAnchors()
 
 void MultiSplitterLayout::redistributeSpace()
 {
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_RedistributeSpace);
     positionStaticAnchors();
     redistributeSpace_recursive(m_leftAnchor, 0);
     redistributeSpace_recursive(m_topAnchor, 0);
@@ -1100,6 +1318,7 @@ void MultiSplitterLayout::redistributeSpace()
 
 void MultiSplitterLayout::redistributeSpace(QSize oldSize, QSize newSize)
 {
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_RedistributeSpace);
     positionStaticAnchors();
     if (oldSize == newSize || !oldSize.isValid() || !newSize.isValid())
         return;
@@ -1117,42 +1336,23 @@ void MultiSplitterLayout::redistributeSpace(QSize oldSize, QSize newSize)
 
 void MultiSplitterLayout::redistributeSpace_recursive(Anchor *fromAnchor, int minAnchorPos)
 {
-    for (Item *item : fromAnchor->items(Anchor::Side2)) {
-        Anchor *nextAnchor = item->anchorAtSide(Anchor::Side2, fromAnchor->orientation());
-        if (nextAnchor->isStatic())
-            continue;
-
-        // We use the minPos of the Anchor that had non-placeholder items on its side1.
-        if (nextAnchor->hasNonPlaceholderItems(Anchor::Side1))
-            minAnchorPos = nextAnchor->minPosition();
-
-        if (nextAnchor->hasNonPlaceholderItems(Anchor::Side2) && !nextAnchor->isFollowing()) {
-            const int newPosition = int(nextAnchor->positionPercentage() * length(nextAnchor->orientation()));
-
-            // But don't let the anchor go out of bounds, it must respect its widgets min sizes
-            auto bounds = boundPositionsForAnchor(nextAnchor);
-
-            // For the bounding, use Anchor::minPosition, as we're not making the anchors on the left/top shift, which boundsPositionsForAnchor() assumes.
-            const int newPositionBounded = qMax(bounds.first, qBound(minAnchorPos, newPosition, bounds.second));
-
-            qCDebug(sizing) << Q_FUNC_INFO << nextAnchor << "bounds.first=" << bounds.first
-                            << "; newPosition=" << newPosition
-                            << "; bounds.first=" << bounds.first
-                            << "; bounds.second=" << bounds.second
-                            << "; newPositionBounded=" << newPositionBounded
-                            << "; oldPosition=" << nextAnchor->position()
-                            << "; size=" << m_size
-                            << "; nextAnchor.minPosition=" << minAnchorPos;
-
-            nextAnchor->setPosition(newPositionBounded, Anchor::SetPositionOption_DontRecalculatePercentage);
-        }
-
-        redistributeSpace_recursive(nextAnchor, minAnchorPos);
-    }
+    LayoutMath<LayoutGraph>::redistributeSpace_recursive(LayoutGraph(this), fromAnchor, minAnchorPos, [this] (Anchor *anchor, int position) {
+        qCDebug(sizing) << "MultiSplitterLayout::redistributeSpace_recursive" << anchor
+                        << "; newPosition=" << position
+                        << "; oldPosition=" << anchor->position()
+                        << "; size=" << m_size;
+        anchor->setPosition(position, Anchor::SetPositionOption_DontRecalculatePercentage);
+    });
 }
 
 void MultiSplitterLayout::updateSizeConstraints()
 {
+    if (m_addingBatchLevel > 0) {
+        // Walks every anchor chain, no point doing it for each insertion. endAddingBatch() does it.
+        m_sizeConstraintsPending = true;
+        return;
+    }
+
     const int minH = m_topAnchor->cumulativeMinLength(Anchor::Side2);
     const int minW = m_leftAnchor->cumulativeMinLength(Anchor::Side2);
 
@@ -1427,14 +1627,14 @@ bool MultiSplitterLayout::checkSanity(AnchorSanityOption options) const
             }
         }
 
-        if (!anchor->isFollowing() &&anchor->geometry() != anchor->separatorWidget()->geometry()) {
+        if (!anchor->isFollowing() && anchor->separatorWidget() && anchor->geometry() != anchor->separatorWidget()->geometry()) {
             qWarning() << Q_FUNC_INFO << anchor << anchor->separatorWidget()
                        << "Inconsistent anchor geometry" << anchor->geometry() << "; " << anchor->separatorWidget()->geometry();
             return false;
         }
 
         if (options & AnchorSanity_Visibility) {
-            if (multiSplitter()->isVisible() && !anchor->isFollowing() && !anchor->separatorWidget()->isVisible()) {
+            if (multiSplitter()->isVisible() && !anchor->isFollowing() && !anchor->isVisible()) {
                 qWarning() << Q_FUNC_INFO << "Anchor should be visible" << anchor;
                 return false;
             }
@@ -1457,7 +1657,7 @@ bool MultiSplitterLayout::checkSanity(AnchorSanityOption options) const
                     dumpDebug();
                     qWarning() << "MultiSplitterLayout::checkSanity: Widget" << item << "with rect" << item->geometry()
                                << "Intersects anchor" << a << "with rect" << a->geometry()
-                               << "; a.visible|following|valid|unneeded=" << a->separatorWidget()->isVisible()<< a->isFollowing() << a->isValid() << a->isUnneeded();
+                               << "; a.visible|following|valid|unneeded=" << a->isVisible() << a->isFollowing() << a->isValid() << a->isUnneeded();
                     return false;
                 }
             }
@@ -1544,6 +1744,9 @@ bool MultiSplitterLayout::checkSanity(AnchorSanityOption options) const
 void MultiSplitterLayout::maybeCheckSanity()
 {
 #if defined(DOCKS_DEVELOPER_MODE)
+    if (isInGeometryTransaction())
+        return; // Frames still have their old geometry, we'll check when committing
+
     if (!isRestoringPlaceholder() && !checkSanity(AnchorSanityOption(AnchorSanity_All & ~AnchorSanity_Visibility)))
         qWarning() << Q_FUNC_INFO << "Sanity check failed";
 #endif
@@ -1567,7 +1770,10 @@ void MultiSplitterLayout::ensureHasAvailableSize(QSize needed)
 
 void MultiSplitterLayout::restorePlaceholder(Item *item)
 {
+    LayoutStatsScope stats(m_stats, LayoutStats::Operation_RestorePlaceholder); // Before the transaction, so its commit is included
+    applyPendingSize();
     QScopedValueRollback<bool> restoring(m_restoringPlaceholder, true);
+    GeometryTransaction transaction(this);
 
     AnchorGroup anchorGroup = item->anchorGroup();
 
@@ -1704,6 +1910,30 @@ void MultiSplitterLayout::unrefOldPlaceholders(const Frame::List &framesBeingAdd
     }
 }
 
+void MultiSplitterLayout::requestSize(QSize size)
+{
+    if (!(Config::self().flags() & Config::Flag_CoalesceResizes)) {
+        setSize(size);
+        return;
+    }
+
+    m_pendingSize = size;
+    if (!m_sizePending) {
+        m_sizePending = true;
+        // A 0 timer runs after the pending resize events, so we only lay out once for all of them
+        QTimer::singleShot(0, this, &MultiSplitterLayout::applyPendingSize);
+    }
+}
+
+void MultiSplitterLayout::applyPendingSize()
+{
+    if (!m_sizePending)
+        return;
+
+    m_sizePending = false;
+    setSize(m_pendingSize);
+}
+
 void MultiSplitterLayout::setSize(QSize size)
 {
     if (size != m_size) {
@@ -1725,8 +1955,10 @@ void MultiSplitterLayout::setSize(QSize size)
 #endif
 
         m_size = size;
+        invalidateRectForDropCache();
         Q_EMIT sizeChanged(size);
 
+        GeometryTransaction transaction(this);
         redistributeSpace(oldSize, size);
         m_resizing = false;
 
@@ -1887,6 +2119,12 @@ QHash<Anchor*, Anchor*> MultiSplitterLayout::anchorsShouldFollow() const
 void MultiSplitterLayout::insertAnchor(Anchor *anchor)
 {
     m_anchors.append(anchor);
+    invalidateCumulativeMinLengthCache();
+
+    // Geometry changes are reported by Anchor::setGeometry() directly
+    connect(anchor, &Anchor::fromChanged, this, &MultiSplitterLayout::invalidateSerializeCache);
+    connect(anchor, &Anchor::toChanged, this, &MultiSplitterLayout::invalidateSerializeCache);
+    connect(anchor, &Anchor::followeeChanged, this, &MultiSplitterLayout::invalidateSerializeCache);
 }
 
 const ItemList MultiSplitterLayout::items() const
@@ -1915,6 +2153,7 @@ bool MultiSplitterLayout::eventFilter(QObject *o, QEvent *e)
 
 bool MultiSplitterLayout::deserialize(const LayoutSaver::MultiSplitterLayout &msl)
 {
+    m_sizePending = false; // The restored size wins
     clear(true);
 
     ItemList items;
@@ -1991,6 +2230,8 @@ bool MultiSplitterLayout::deserialize(const LayoutSaver::MultiSplitterLayout &ms
         item->setProperty("bottomIndex", QVariant());
     }
 
+    invalidateCumulativeMinLengthCache();
+
     if (!m_items.isEmpty())
         Q_EMIT widgetCountChanged(m_items.size());
 
@@ -2007,18 +2248,220 @@ bool MultiSplitterLayout::deserialize(const LayoutSaver::MultiSplitterLayout &ms
     return true;
 }
 
+bool MultiSplitterLayout::matchesStructure(const LayoutSaver::MultiSplitterLayout &msl) const
+{
+    if (msl.anchors.size() != m_anchors.size() || msl.items.size() != m_items.size())
+        return false;
+
+    QHash<const Anchor*, int> anchorIndexes;
+    anchorIndexes.reserve(m_anchors.size());
+    for (int i = 0; i < m_anchors.size(); ++i)
+        anchorIndexes.insert(m_anchors.at(i), i);
+
+    QHash<const Item*, int> itemIndexes;
+    itemIndexes.reserve(m_items.size());
+    for (int i = 0; i < m_items.size(); ++i)
+        itemIndexes.insert(m_items.at(i), i);
+
+    auto sameItems = [&itemIndexes] (const ItemList &items, const QVector<int> &savedIndexes) {
+        if (items.size() != savedIndexes.size())
+            return false;
+        for (int i = 0; i < items.size(); ++i) {
+            if (itemIndexes.value(items.at(i), -1) != savedIndexes.at(i))
+                return false;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < m_anchors.size(); ++i) {
+        const Anchor *anchor = m_anchors.at(i);
+        const LayoutSaver::Anchor &saved = msl.anchors.at(i);
+        if (saved.type != anchor->type() || saved.orientation != anchor->orientation() ||
+            saved.indexOfFrom != anchorIndexes.value(anchor->from(), -1) ||
+            saved.indexOfTo != anchorIndexes.value(anchor->to(), -1) ||
+            saved.indexOfFollowee != anchorIndexes.value(anchor->followee(), -1) ||
+            !sameItems(anchor->side1Items(), saved.side1Items) ||
+            !sameItems(anchor->side2Items(), saved.side2Items)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < m_items.size(); ++i) {
+        const Item *item = m_items.at(i);
+        const LayoutSaver::Item &saved = msl.items.at(i);
+        const AnchorGroup &group = item->anchorGroup();
+        if (saved.isPlaceholder != item->isPlaceholder() ||
+            saved.indexOfLeftAnchor != anchorIndexes.value(group.left, -1) ||
+            saved.indexOfTopAnchor != anchorIndexes.value(group.top, -1) ||
+            saved.indexOfRightAnchor != anchorIndexes.value(group.right, -1) ||
+            saved.indexOfBottomAnchor != anchorIndexes.value(group.bottom, -1)) {
+            return false;
+        }
+
+        if (!item->isPlaceholder() && !item->frame()->hasSameDockWidgets(saved.frame))
+            return false;
+    }
+
+    return true;
+}
+
+bool MultiSplitterLayout::deserializeInPlace(const LayoutSaver::MultiSplitterLayout &msl)
+{
+    m_sizePending = false; // The restored size wins, like in deserialize()
+
+    if (!matchesStructure(msl)) {
+        qWarning() << Q_FUNC_INFO << "Saved layout has a different structure";
+        return false;
+    }
+
+    for (int i = 0; i < m_anchors.size(); ++i)
+        m_anchors.at(i)->restoreGeometry(msl.anchors.at(i));
+
+    for (int i = 0; i < m_items.size(); ++i) {
+        Item *item = m_items.at(i);
+        const LayoutSaver::Item &saved = msl.items.at(i);
+        item->restoreSizes(saved.minSize, saved.geometry);
+
+        if (!item->isPlaceholder()) {
+            // Frame::deserialize() would do this for us when creating new frames
+            for (const auto &savedDock : qAsConst(saved.frame.dockWidgets))
+                DockWidgetBase::deserialize(savedDock);
+            item->frame()->setCurrentTabIndex(saved.frame.currentTabIndex);
+        }
+    }
+
+    m_size = msl.size;
+    m_minSize = msl.minSize;
+    invalidateCumulativeMinLengthCache();
+
+    Q_EMIT minimumSizeChanged(m_minSize);
+
+    if (m_size != multiSplitter()->size())
+        setSize(multiSplitter()->size());
+
+    return true;
+}
+
+LayoutModel MultiSplitterLayout::toLayoutModel() const
+{
+    QHash<const Anchor*, int> anchorIndexes;
+    anchorIndexes.reserve(m_anchors.size());
+    for (int i = 0; i < m_anchors.size(); ++i)
+        anchorIndexes.insert(m_anchors.at(i), i);
+
+    QHash<const Item*, int> itemIndexes;
+    itemIndexes.reserve(m_items.size());
+    for (int i = 0; i < m_items.size(); ++i)
+        itemIndexes.insert(m_items.at(i), i);
+
+    auto anchorIndex = [&anchorIndexes] (const Anchor *anchor) {
+        return anchorIndexes.value(anchor, -1);
+    };
+
+    auto itemIndexList = [&itemIndexes] (const ItemList &items) {
+        QVector<int> result;
+        result.reserve(items.size());
+        for (Item *item : items)
+            result.push_back(itemIndexes.value(item));
+        return result;
+    };
+
+    LayoutModel model;
+    model.size = m_size;
+    model.staticAnchorThickness = Anchor::thickness(true);
+    model.anchorThickness = Anchor::thickness(false);
+    model.leftAnchor = anchorIndex(m_leftAnchor);
+    model.topAnchor = anchorIndex(m_topAnchor);
+    model.rightAnchor = anchorIndex(m_rightAnchor);
+    model.bottomAnchor = anchorIndex(m_bottomAnchor);
+
+    model.anchors.reserve(m_anchors.size());
+    for (Anchor *anchor : m_anchors) {
+        AnchorData a;
+        a.orientation = anchor->orientation();
+        a.type = anchor->type();
+        a.position = anchor->position();
+        a.thickness = anchor->thickness();
+        a.positionPercentage = anchor->positionPercentage();
+        a.from = anchorIndex(anchor->from());
+        a.to = anchorIndex(anchor->to());
+        a.followee = anchorIndex(anchor->followee());
+        a.side1Items = itemIndexList(anchor->side1Items());
+        a.side2Items = itemIndexList(anchor->side2Items());
+        model.anchors.push_back(a);
+    }
+
+    for (int i = 0; i < model.anchors.size(); ++i) {
+        const int followee = model.anchors.at(i).followee;
+        if (followee != -1)
+            model.anchors[followee].followers.push_back(i);
+    }
+
+    model.items.reserve(m_items.size());
+    for (Item *item : m_items) {
+        const AnchorGroup &group = item->anchorGroup();
+        ItemData i;
+        i.geometry = item->geometry();
+        i.minSize = item->actualMinSize();
+        i.isPlaceholder = item->isPlaceholder();
+        i.leftAnchor = anchorIndex(group.left);
+        i.topAnchor = anchorIndex(group.top);
+        i.rightAnchor = anchorIndex(group.right);
+        i.bottomAnchor = anchorIndex(group.bottom);
+        model.items.push_back(i);
+    }
+
+    return model;
+}
+
+bool MultiSplitterLayout::applyLayoutModel(const LayoutModel &model)
+{
+    if (model.anchors.size() != m_anchors.size() || model.items.size() != m_items.size()) {
+        qWarning() << Q_FUNC_INFO << "Model doesn't match this layout";
+        return false;
+    }
+
+    if (model.size != m_size) {
+        qWarning() << Q_FUNC_INFO << "Model has a different size" << model.size << m_size;
+        return false;
+    }
+
+    // Followers get their position from their followee
+    GeometryTransaction transaction(this);
+    for (int i = 0; i < m_anchors.size(); ++i) {
+        Anchor *anchor = m_anchors.at(i);
+        if (anchor->isStatic() || anchor->isFollowing())
+            continue;
+        anchor->setPosition(model.anchors.at(i).position, Anchor::SetPositionOption_DontRecalculatePercentage);
+        anchor->m_positionPercentage = model.anchors.at(i).positionPercentage;
+    }
+
+    return true;
+}
+
 LayoutSaver::MultiSplitterLayout MultiSplitterLayout::serialize() const
 {
+    if (!m_serializeCacheDirty)
+        return m_serializeCache;
+
     LayoutSaver::MultiSplitterLayout l;
 
     l.size = size();
     l.minSize = minimumSize();
 
+    l.items.reserve(m_items.size());
     for (Item *item : m_items)
         l.items.push_back(item->serialize());
 
+    l.anchors.reserve(m_anchors.size());
     for (Anchor *anchor : m_anchors)
         l.anchors.push_back(anchor->serialize());
 
+    // Encoding it to JSON or binary is cached too, until the layout changes again
+    l.encodingCache = std::make_shared<LayoutSaver::MultiSplitterLayout::EncodingCache>();
+
+    m_serializeCache = l;
+    m_serializeCacheDirty = false;
+
     return l;
 }
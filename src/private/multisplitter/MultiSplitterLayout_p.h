@@ -39,13 +39,18 @@
 #include "KDDockWidgets.h"
 #include "Item_p.h"
 #include "LayoutSaver_p.h"
+#include "LayoutModel_p.h"
+#include "LayoutStats_p.h"
 
 #include <QPointer>
+#include <QHash>
+#include <QSet>
 
 namespace KDDockWidgets {
 
 class MultiSplitter;
 class Length;
+class LazyResizePreview;
 
 namespace Debug {
 class DebugWindow;
@@ -139,6 +144,16 @@ public:
      */
     void addWidget(QWidgetOrQuick *widget, KDDockWidgets::Location location, Frame *relativeTo = nullptr, AddingOption option = {});
 
+    /**
+     * @brief Groups several addWidget() calls, until the matching endAddingBatch().
+     *
+     * Meanwhile the frame geometries are only computed, they're applied once at the end, together
+     * with a single widgetCountChanged() emission and sanity check. The layout's min size is also
+     * only updated at the end. Can be nested.
+     */
+    void beginAddingBatch();
+    void endAddingBatch();
+
     /**
      * Adds an entire MultiSplitter into this layout. The donor MultiSplitter will be deleted
      * after all its Frames are stolen. All added Frames will preserve their original layout, so,
@@ -171,9 +186,18 @@ public:
 
     /**
      * @brief Returns the visible Item at pos @p p.
+     *
+     * Backed by a grid over item geometries which is rebuilt lazily when geometry changes,
+     * so this is cheap to call on every mouse move of a drag.
      */
     Item *itemAt(QPoint p) const;
 
+    /**
+     * @brief Returns the visible, resizable Anchor at pos @p p, or nullptr.
+     * Used for hit-testing when there's no separator widget, see Config::Flag_LightweightSeparators.
+     */
+    Anchor *anchorAt(QPoint p) const;
+
     /**
      * @brief Removes all Items, Anchors and Frames docked in this layout.
      * DockWidgets are closed but not deleted.
@@ -201,6 +225,15 @@ public:
      */
     int placeholderCount() const;
 
+    /**
+     * @brief Removes the least recently used placeholders so there's at most
+     * Config::maxPlaceholdersPerLayout() left. Anchors left without items are merged away.
+     *
+     * This runs automatically shortly after an item turns into a placeholder.
+     * @return the number of placeholders removed
+     */
+    int compactPlaceholders();
+
     /**
      * @brief Returns true if count is 0.
      */
@@ -229,9 +262,53 @@ public:
      */
     QRect rectForDrop(const QWidgetOrQuick *widget, KDDockWidgets::Location location, const Item *relativeTo) const;
 
+    /**
+     * @brief Enables memoizing the rectForDrop() results. Disabling it clears them.
+     *
+     * DropArea enables it while a window is dragged over it, as that's when the indicators ask for
+     * the same rects over and over. Disabled by default.
+     */
+    void setRectForDropCacheEnabled(bool);
+
     bool deserialize(const LayoutSaver::MultiSplitterLayout &);
     LayoutSaver::MultiSplitterLayout serialize() const;
 
+    /**
+     * @brief Returns a widget-free copy of this layout, which can be solved with LayoutSolver,
+     * for example in another thread
+     */
+    LayoutModel toLayoutModel() const;
+
+    /**
+     * @brief Applies the anchor positions of @p model, which must have been created by
+     * toLayoutModel() and not had its structure changed since.
+     * @return false if the structure doesn't match
+     */
+    bool applyLayoutModel(const LayoutModel &model);
+
+    /**
+     * @brief Returns how many times this layout's expensive operations ran and how long they took.
+     * Meant to find which user actions are slow in the field. Also shown by the DebugWindow.
+     */
+    const LayoutStats &stats() const;
+
+    ///@brief Zeroes the counters returned by stats()
+    void resetStats();
+
+    /**
+     * @brief Returns whether @p msl only differs from this layout in sizes.
+     *
+     * That is, it has the same anchors connected in the same way, and the same items, showing frames
+     * with the same dock widgets. In that case deserializeInPlace() can be used instead of deserialize().
+     */
+    bool matchesStructure(const LayoutSaver::MultiSplitterLayout &msl) const;
+
+    /**
+     * @brief Restores the sizes saved in @p msl, reusing the existing items, frames and separators.
+     * Only valid if matchesStructure() returns true. See RestoreOption_Incremental.
+     */
+    bool deserializeInPlace(const LayoutSaver::MultiSplitterLayout &msl);
+
     void setAnchorBeingDragged(Anchor *);
     Anchor *anchorBeingDragged() const { return m_anchorBeingDragged; }
     bool anchorIsBeingDragged() const { return m_anchorBeingDragged != nullptr; }
@@ -273,6 +350,16 @@ public:
      */
     void setSize(QSize);
 
+    /**
+     * @brief Like setSize(), but with Config::Flag_CoalesceResizes set the size is only applied
+     * once per event loop iteration, using the latest requested size.
+     * Called when the MultiSplitter is resized.
+     */
+    void requestSize(QSize);
+
+    ///@brief Applies the size passed to requestSize() right away, if it's still pending
+    void applyPendingSize();
+
     /**
      * @brief sets either the contents height if @p o is Qt::Horizontal, otherwise sets the contents width
      */
@@ -370,35 +457,7 @@ public:
      */
     QPair<AnchorGroup, Anchor *> createTargetAnchorGroup(Location location, Item *relativeToItem);
 
-    struct Length {
-        Length() = default;
-        Length(int side1, int side2)
-            : side1Length(side1)
-            , side2Length(side2)
-        {}
-
-        int side1Length = 0;
-        int side2Length = 0;
-        int length() const { return side1Length + side2Length; }
-
-        void setLength(int newLength)
-        {
-            // Sets the new length, preserving proportion
-            side1Length = int(side1Factor() * newLength);
-            side2Length = newLength - side1Length;
-        }
-
-        bool isNull() const
-        {
-            return length() <= 0;
-        }
-
-    private:
-        qreal side1Factor() const
-        {
-            return (1.0 * side1Length) / length();
-        }
-    };
+    typedef DropLength Length;
 
 Q_SIGNALS:
     ///@brief emitted when the number of widgets changes
@@ -488,6 +547,67 @@ private:
     void insertAnchor(Anchor *);
     void removeAnchor(Anchor *);
 
+    /**
+     * @brief Clears the memoized Anchor::cumulativeMinLength() results.
+     *
+     * Must be called whenever an item's min size, an item's placeholder state or the anchor topology
+     * changes. Moving anchors doesn't invalidate it, so bound queries while dragging a separator are cheap.
+     */
+    void invalidateCumulativeMinLengthCache();
+
+    /**
+     * @brief Clears only the memoized Anchor::cumulativeMinLength() results that depend on @p item.
+     *
+     * Enough when an item's min size or placeholder state changes, as the anchor topology stays the same.
+     * Only the anchor chains from the item up to the static anchors are visited, and only for @p orientations.
+     */
+    void invalidateCumulativeMinLengthCache(Item *item, Qt::Orientations orientations = Qt::Horizontal | Qt::Vertical);
+    void invalidateCumulativeMinLength_recursive(Anchor *anchor, Anchor::Side side, QSet<Anchor*> &visited);
+
+    ///@brief LayoutMath's view of this layout's anchors and items. The math itself is shared with LayoutSolver.
+    struct LayoutGraph;
+
+    ///@brief Implementation of Anchor::cumulativeMinLength(), see LayoutMath::cumulativeMinLength()
+    int cumulativeMinLength(Anchor *anchor, Anchor::Side side) const;
+
+    ///@brief Implementation of Item::ensureMinSize(), see LayoutMath::ensureMinSize()
+    void ensureMinSize(Item *item, Qt::Orientation orientation);
+    void ensureMinSize(Item *item, Qt::Orientation orientation, Anchor::Side side);
+
+    ///@brief Called by Item::setGeometry() while in a transaction, so the Frame's geometry is applied on commit
+    void scheduleGeometryUpdate(Item *);
+
+    ///@brief Marks the itemAt() grid as stale. Called when an item is added, removed or changes geometry
+    void invalidateHitTestIndex();
+
+    ///@brief Rebuilds the itemAt() grid if it's stale
+    void ensureHitTestIndex() const;
+
+    /**
+     * @brief Clears the memoized rectForDrop() results.
+     *
+     * Called when the cache is disabled and whenever item geometry, the layout size or min sizes change.
+     */
+    void invalidateRectForDropCache();
+
+    /**
+     * @brief Marks the snapshot returned by serialize() as stale.
+     *
+     * Called whenever something that's saved changes: items, their geometry, min size or frame tabs,
+     * anchors, or the layout's size. Unchanged layouts reuse their snapshot on the next save.
+     */
+    void invalidateSerializeCache();
+
+    /**
+     * @brief Shows where the items would go if @p anchor was moved to @p pos.
+     * Used by Config::Flag_LazyResize, nothing is resized until the separator is released.
+     */
+    void showLazyResizePreview(Anchor *anchor, int pos);
+    void hideLazyResizePreview();
+
+    ///@brief Schedules compactPlaceholders() if we're over the placeholder budget
+    void scheduleCompactPlaceholders();
+
     /**
      * Returns the min or max position that an anchor can go to (due to minimum size restriction on the widgets).
      * For example, if the anchor is vertical and direction is Side1 then it returns the minimum x
@@ -574,9 +694,6 @@ private:
      */
     void propagateResize(int delta, Anchor *fromAnchor, Anchor::Side direction);
 
-    // Helper function for propagateResize()
-    void collectPaths(QVector<Anchor::List> &paths, Anchor *fromAnchor, Anchor::Side direction);
-
     // convenience for the unit-tests
     // Moves the widget's bottom or right anchor, to resize it.
     void resizeItem(Frame *frame, int newSize, Qt::Orientation);
@@ -588,6 +705,42 @@ private:
     bool isRestoringPlaceholder() const { return m_restoringPlaceholder; }
     bool isAddingItem() const { return m_addingItem; }
 
+    /**
+     * @brief Starts a geometry transaction.
+     *
+     * While a transaction is open Item::setGeometry() only updates the Item's own rect; the
+     * Frame's QWidget::setGeometry() and Item::geometryChanged() are deferred until the outermost
+     * commitGeometryTransaction(), so each frame is moved/resized at most once no matter how many
+     * times its anchors moved. Transactions can be nested.
+     */
+    void beginGeometryTransaction();
+
+    ///@brief Ends a transaction started with beginGeometryTransaction(), applying the pending frame geometries if it's the outermost one
+    void commitGeometryTransaction();
+
+    ///@brief returns whether we're inside a geometry transaction
+    bool isInGeometryTransaction() const { return m_geometryTransactionLevel > 0; }
+
+    ///@brief RAII helper to call begin/commitGeometryTransaction()
+    class GeometryTransaction
+    {
+    public:
+        explicit GeometryTransaction(MultiSplitterLayout *layout)
+            : m_layout(layout)
+        {
+            m_layout->beginGeometryTransaction();
+        }
+
+        ~GeometryTransaction()
+        {
+            m_layout->commitGeometryTransaction();
+        }
+
+    private:
+        Q_DISABLE_COPY(GeometryTransaction)
+        MultiSplitterLayout *const m_layout;
+    };
+
     QString affinityName() const;
 
     MultiSplitter *const m_multiSplitter;
@@ -605,11 +758,48 @@ private:
     bool m_restoringPlaceholder = false;
     bool m_resizing = false;
     bool m_addingItem = false;
+    int m_addingBatchLevel = 0;
+    bool m_sizeConstraintsPending = false; // updateSizeConstraints() was deferred by an adding batch
 
     QSize m_minSize = QSize(0, 0);
     AnchorGroup m_staticAnchorGroup;
     QPointer<Anchor> m_anchorBeingDragged;
     QSize m_size;
+
+    // Memoization for LayoutMath::cumulativeMinLength(), keyed by (anchor, side)
+    mutable QHash<QPair<const Anchor*, int>, CumulativeMin> m_cumulativeMinLengthCache;
+
+    int m_geometryTransactionLevel = 0;
+    QVector<QPointer<Item>> m_pendingGeometryItems; // Items whose Frame geometry is deferred until commitGeometryTransaction()
+
+    // Uniform grid over item geometries, for itemAt(). Each cell lists the items intersecting it.
+    mutable QVector<ItemList> m_hitTestGrid;
+    mutable QRect m_hitTestBounds;
+    mutable QSize m_hitTestCellSize;
+    mutable int m_hitTestColumns = 0;
+    mutable bool m_hitTestIndexDirty = true;
+
+    bool m_compactPlaceholdersPending = false;
+    QPointer<LazyResizePreview> m_lazyResizePreview; // Created on the first lazy separator drag
+
+    QSize m_pendingSize; // Set by requestSize() with Config::Flag_CoalesceResizes
+    bool m_sizePending = false;
+
+    // Memoization for rectForDrop(), keyed by (relativeTo, location). Only used while a DropArea enables it, as
+    // that's when the indicators ask for the same rect over and over.
+    struct RectForDrop {
+        QSize widgetSize;
+        QRect rect;
+    };
+    mutable QHash<QPair<const Item*, int>, RectForDrop> m_rectForDropCache;
+    bool m_rectForDropCacheEnabled = false;
+
+    // The last serialize() result. Its containers are implicitly shared, so handing it out is cheap.
+    // Its encodingCache also keeps the JSON and binary encodings, so saving again doesn't re-encode.
+    mutable LayoutSaver::MultiSplitterLayout m_serializeCache;
+    mutable bool m_serializeCacheDirty = true;
+
+    LayoutStats m_stats;
 };
 
 inline QDebug operator<<(QDebug d, const AnchorGroup &group) {
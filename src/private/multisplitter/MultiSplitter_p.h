@@ -58,8 +58,20 @@ public:
 protected:
     void onLayoutRequest() override;
     bool onResize(QSize newSize) override;
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    // With Config::Flag_LightweightSeparators we paint and drag the separators ourselves
+    void paintEvent(QPaintEvent *) override;
+    void mousePressEvent(QMouseEvent *) override;
+    void mouseMoveEvent(QMouseEvent *) override;
+    void mouseReleaseEvent(QMouseEvent *) override;
+    void leaveEvent(QEvent *) override;
+#endif
     MultiSplitterLayout *const m_layout;
 private:
+#ifdef KDDOCKWIDGETS_QTWIDGETS
+    void updateSeparatorCursor(QPoint pos);
+    const bool m_lightweightSeparators;
+#endif
     bool m_inResizeEvent = false;
 };
 
@@ -0,0 +1,442 @@
+/*
+  This file is part of KDDockWidgets.
+
+  Copyright (C) 2019-2020 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+  Author: Sérgio Martins <sergio.martins@kdab.com>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// We don't care about performance related checks in the tests
+// clazy:excludeall=ctor-missing-parent-argument,missing-qobject-macro,range-loop,missing-typeinfo,detaching-member,function-args-by-ref,non-pod-global-static,reserve-candidates,qstring-allocations
+
+/**
+ * @file
+ * @brief Benchmarks for the MultiSplitterLayout engine.
+ *
+ * Each scenario is measured twice: once for wall time (QTest::WalltimeMilliseconds) and once for
+ * the number of operator new calls (QTest::Events). The latter doesn't include Qt's containers and
+ * implicitly shared data, which allocate with malloc(), so it's not a count of all heap allocations.
+ * Only the operation being benchmarked is measured, the layout is built beforehand. Each measurement
+ * is the median of KDDOCKWIDGETS_BENCH_ITERATIONS runs (5 by default).
+ *
+ * Use QTest's output options to get machine-readable results, for example:
+ *     bench_multisplitter -o results.csv,csv
+ *     bench_multisplitter -o results.xml,xml
+ */
+
+#include "DockWidget.h"
+#include "MainWindow.h"
+#include "Frame_p.h"
+#include "LastPosition_p.h"
+#include "FrameworkWidgetFactory.h"
+#include "Config.h"
+#include "multisplitter/MultiSplitterLayout_p.h"
+#include "multisplitter/Anchor_p.h"
+#include "multisplitter/Separator_p.h"
+#include "utils.h"
+
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QStyleFactory>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Tests;
+
+static std::atomic<quint64> s_newCallCount(0);
+
+// Replacing the global operator new counts the objects created by Qt and KDDW too, not only ours.
+// Qt's own containers allocate via malloc() and aren't included.
+void *operator new(std::size_t size)
+{
+    s_newCallCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+enum Metric {
+    Metric_Walltime = 0,
+    Metric_NewCalls ///< operator new calls, see the file's comment
+};
+
+/// @brief The layout the scenarios run on
+struct Fixture {
+    std::unique_ptr<MainWindow> mainWindow;
+    QVector<DockWidgetBase*> docks;
+
+    MultiSplitterLayout *layout() const
+    {
+        return mainWindow->multiSplitterLayout();
+    }
+};
+
+/// @brief A benchmark scenario. Only run() is measured. setup() returns false if it failed.
+struct Scenario {
+    std::function<bool()> setup;
+    std::function<void()> run;
+    std::function<void()> teardown;
+};
+
+}
+
+Q_DECLARE_METATYPE(Metric)
+
+static int iterations()
+{
+    bool ok = false;
+    const int result = qEnvironmentVariableIntValue("KDDOCKWIDGETS_BENCH_ITERATIONS", &ok);
+    return ok && result > 0 ? result : 5;
+}
+
+/// @brief Runs and measures @p scenario. Returns false if its setup failed.
+static bool measure(Metric metric, const Scenario &scenario)
+{
+    QVector<qint64> samples;
+    const int count = iterations();
+    samples.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        if (scenario.setup && !scenario.setup()) {
+            if (scenario.teardown)
+                scenario.teardown();
+            return false;
+        }
+
+        if (metric == Metric_Walltime) {
+            QElapsedTimer timer;
+            timer.start();
+            scenario.run();
+            samples.push_back(timer.nsecsElapsed());
+        } else {
+            const quint64 before = s_newCallCount.load();
+            scenario.run();
+            samples.push_back(qint64(s_newCallCount.load() - before));
+        }
+
+        if (scenario.teardown)
+            scenario.teardown();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const qint64 median = samples.at(samples.size() / 2);
+
+    if (metric == Metric_Walltime)
+        QTest::setBenchmarkResult(median / 1000000.0, QTest::WalltimeMilliseconds);
+    else
+        QTest::setBenchmarkResult(median, QTest::Events);
+
+    return true;
+}
+
+/// @brief Creates a main window with @p numDocks dock widgets, but doesn't add them yet
+static void createFixture(Fixture &fixture, int numDocks)
+{
+    static int count = 0;
+    count++;
+
+    fixture.mainWindow = createMainWindow(QSize(1000, 1000), MainWindowOption_None,
+                                          QStringLiteral("bench%1").arg(count));
+    fixture.docks.clear();
+    fixture.docks.reserve(numDocks);
+    for (int i = 0; i < numDocks; ++i) {
+        const QString name = QStringLiteral("bench%1-dock%2").arg(count).arg(i);
+        fixture.docks.push_back(createDockWidget(name, new QWidget(), {}, /*show=*/ false));
+    }
+}
+
+/// @brief Adds all the fixture's docks to its layout, alternating between right and bottom so
+/// we get a nested layout, which is the expensive case.
+static void addDocks(Fixture &fixture)
+{
+    MultiSplitterLayout *layout = fixture.layout();
+    Frame *previous = nullptr;
+    for (int i = 0; i < fixture.docks.size(); ++i) {
+        auto frame = Config::self().frameworkWidgetFactory()->createFrame();
+        frame->addWidget(fixture.docks.at(i));
+        layout->addWidget(frame, i % 2 ? Location_OnBottom : Location_OnRight, previous);
+        previous = frame;
+    }
+}
+
+static void destroyFixture(Fixture &fixture)
+{
+    fixture.docks.clear();
+    fixture.mainWindow.reset();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+/// @brief Returns the non-static separator that's closest to the middle of the layout
+static Anchor *middleAnchor(MultiSplitterLayout *layout, Qt::Orientation orientation)
+{
+    Anchor *result = nullptr;
+    const int middle = (orientation == Qt::Vertical ? layout->width() : layout->height()) / 2;
+    for (Anchor *anchor : layout->anchors(orientation, /*includeStatic=*/ false, /*includePlaceholders=*/ false)) {
+        if (anchor->isFollowing())
+            continue;
+        if (!result || qAbs(anchor->position() - middle) < qAbs(result->position() - middle))
+            result = anchor;
+    }
+
+    return result;
+}
+
+static void addRows(const QVector<int> &sizes)
+{
+    QTest::addColumn<int>("numDocks");
+    QTest::addColumn<Metric>("metric");
+
+    for (int n : sizes) {
+        QTest::newRow(qPrintable(QStringLiteral("N=%1 walltime").arg(n))) << n << Metric_Walltime;
+        QTest::newRow(qPrintable(QStringLiteral("N=%1 new calls").arg(n))) << n << Metric_NewCalls;
+    }
+}
+
+class BenchMultiSplitter : public QObject
+{
+    Q_OBJECT
+public Q_SLOTS:
+    void initTestCase()
+    {
+        qApp->setOrganizationName(QStringLiteral("KDAB"));
+        qApp->setApplicationName(QStringLiteral("dockwidgets-benchmarks"));
+        qApp->setStyle(QStyleFactory::create(QStringLiteral("fusion")));
+    }
+
+private Q_SLOTS:
+    void bench_addWidget_data();
+    void bench_addWidget();
+    void bench_addDockWidgets_data();
+    void bench_addDockWidgets();
+    void bench_separatorDrag_data();
+    void bench_separatorDrag();
+    void bench_setSize_data();
+    void bench_setSize();
+    void bench_restorePlaceholder_data();
+    void bench_restorePlaceholder();
+};
+
+void BenchMultiSplitter::bench_addWidget_data()
+{
+    addRows({ 10, 100, 500 });
+}
+
+void BenchMultiSplitter::bench_addWidget()
+{
+    QFETCH(int, numDocks);
+    QFETCH(Metric, metric);
+
+    Fixture fixture;
+    Scenario scenario;
+    scenario.setup = [&fixture, numDocks] {
+        createFixture(fixture, numDocks);
+        return true;
+    };
+    scenario.run = [&fixture] { addDocks(fixture); };
+    scenario.teardown = [&fixture] { destroyFixture(fixture); };
+
+    QVERIFY(measure(metric, scenario));
+}
+
+void BenchMultiSplitter::bench_addDockWidgets_data()
+{
+    // Sequential addDockWidget() calls vs a single MainWindowBase::addDockWidgets() batch
+    QTest::addColumn<int>("numDocks");
+    QTest::addColumn<Metric>("metric");
+    QTest::addColumn<bool>("batched");
+
+    for (int n : { 10, 100, 500 }) {
+        for (bool batched : { false, true }) {
+            const QString mode = batched ? QStringLiteral("batched") : QStringLiteral("sequential");
+            QTest::newRow(qPrintable(QStringLiteral("N=%1 %2 walltime").arg(n).arg(mode))) << n << Metric_Walltime << batched;
+            QTest::newRow(qPrintable(QStringLiteral("N=%1 %2 new calls").arg(n).arg(mode))) << n << Metric_NewCalls << batched;
+        }
+    }
+}
+
+void BenchMultiSplitter::bench_addDockWidgets()
+{
+    QFETCH(int, numDocks);
+    QFETCH(Metric, metric);
+    QFETCH(bool, batched);
+
+    Fixture fixture;
+    QVector<MainWindowBase::DockWidgetInsertion> insertions;
+
+    Scenario scenario;
+    scenario.setup = [&fixture, &insertions, numDocks] {
+        createFixture(fixture, numDocks);
+        // Same nested layout as addDocks()
+        insertions.clear();
+        for (int i = 0; i < fixture.docks.size(); ++i) {
+            insertions.push_back({ fixture.docks.at(i), i % 2 ? Location_OnBottom : Location_OnRight,
+                                   i > 0 ? fixture.docks.at(i - 1) : nullptr, AddingOption_None });
+        }
+        return true;
+    };
+
+    scenario.run = [&fixture, &insertions, batched] {
+        if (batched) {
+            fixture.mainWindow->addDockWidgets(insertions);
+        } else {
+            for (const MainWindowBase::DockWidgetInsertion &insertion : qAsConst(insertions))
+                fixture.mainWindow->addDockWidget(insertion.dockWidget, insertion.location, insertion.relativeTo, insertion.option);
+        }
+    };
+
+    scenario.teardown = [&fixture] { destroyFixture(fixture); };
+
+    QVERIFY(measure(metric, scenario));
+}
+
+void BenchMultiSplitter::bench_separatorDrag_data()
+{
+    addRows({ 10, 100 });
+}
+
+void BenchMultiSplitter::bench_separatorDrag()
+{
+    // Drags the middle separator 100px to the left and back, through Anchor::onMouseMoved()
+    QFETCH(int, numDocks);
+    QFETCH(Metric, metric);
+
+    Fixture fixture;
+    Anchor *anchor = nullptr;
+    QPoint pressPos;
+
+    Scenario scenario;
+    scenario.setup = [&] {
+        createFixture(fixture, numDocks);
+        addDocks(fixture);
+        if (!QTest::qWaitForWindowExposed(fixture.mainWindow->windowHandle()))
+            return false;
+        anchor = middleAnchor(fixture.layout(), Qt::Vertical);
+        if (!anchor)
+            return false;
+        // Anchor::onMouseMoved() requires the button to be really pressed, so go through QPA
+        Separator *separator = anchor->separatorWidget();
+        pressPos = separator->mapTo(fixture.mainWindow.get(), separator->rect().center());
+        QTest::mousePress(fixture.mainWindow->windowHandle(), Qt::LeftButton, Qt::NoModifier, pressPos);
+        return anchor->isBeingDragged();
+    };
+
+    scenario.run = [&] {
+        const int startPos = anchor->position();
+        const int y = anchor->separatorWidget()->geometry().center().y();
+        for (int delta = 1; delta <= 100; ++delta)
+            anchor->onMouseMoved(QPoint(startPos - delta, y));
+        for (int delta = 99; delta >= 0; --delta)
+            anchor->onMouseMoved(QPoint(startPos - delta, y));
+    };
+
+    scenario.teardown = [&] {
+        if (fixture.mainWindow)
+            QTest::mouseRelease(fixture.mainWindow->windowHandle(), Qt::LeftButton, Qt::NoModifier, pressPos);
+        anchor = nullptr;
+        destroyFixture(fixture);
+    };
+
+    QVERIFY(measure(metric, scenario));
+}
+
+void BenchMultiSplitter::bench_setSize_data()
+{
+    addRows({ 10, 100 });
+}
+
+void BenchMultiSplitter::bench_setSize()
+{
+    // Grows the layout by 200x200 in 5px steps and shrinks it back, like an interactive window resize
+    QFETCH(int, numDocks);
+    QFETCH(Metric, metric);
+
+    Fixture fixture;
+    Scenario scenario;
+    scenario.setup = [&fixture, numDocks] {
+        createFixture(fixture, numDocks);
+        addDocks(fixture);
+        return true;
+    };
+
+    scenario.run = [&fixture] {
+        MultiSplitterLayout *layout = fixture.layout();
+        const QSize startSize = layout->size();
+        for (int delta = 5; delta <= 200; delta += 5)
+            layout->setSize(startSize + QSize(delta, delta));
+        for (int delta = 195; delta >= 0; delta -= 5)
+            layout->setSize(startSize + QSize(delta, delta));
+    };
+
+    scenario.teardown = [&fixture] { destroyFixture(fixture); };
+
+    QVERIFY(measure(metric, scenario));
+}
+
+void BenchMultiSplitter::bench_restorePlaceholder_data()
+{
+    addRows({ 10, 100 });
+}
+
+void BenchMultiSplitter::bench_restorePlaceholder()
+{
+    // Closes a dock widget in the middle of the layout and measures showing it again
+    QFETCH(int, numDocks);
+    QFETCH(Metric, metric);
+
+    Fixture fixture;
+    DockWidgetBase *dock = nullptr;
+
+    Scenario scenario;
+    scenario.setup = [&] {
+        createFixture(fixture, numDocks);
+        addDocks(fixture);
+        dock = fixture.docks.at(numDocks / 2);
+        dock->close();
+        return dock->lastPosition()->isValid();
+    };
+
+    scenario.run = [&] {
+        dock->show();
+    };
+
+    scenario.teardown = [&] {
+        dock = nullptr;
+        destroyFixture(fixture);
+    };
+
+    QVERIFY(measure(metric, scenario));
+}
+
+QTEST_MAIN(BenchMultiSplitter)
+
+#include "bench_multisplitter.moc"
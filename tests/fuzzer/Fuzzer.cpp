@@ -26,11 +26,16 @@
 #include "DockWidget.h"
 #include "MainWindow.h"
 
+#include <QElapsedTimer>
 #include <QJsonDocument>
+#include <QMetaEnum>
 
 #include <QString>
 #include <QTest>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace KDDockWidgets;
 using namespace KDDockWidgets::Testing;
 using namespace KDDockWidgets::Testing::Operations;
@@ -90,11 +95,19 @@ void Fuzzer::runTest(const Test &test)
     if (skipsLast)
         operations.removeLast();
 
+    const bool benchmarks = m_options & Option_Benchmark;
+    QElapsedTimer timer;
     for (const auto &op : operations) {
         index++;
+        timer.start();
         op->execute();
-        if (op->hasParams())
-            qDebug() << "Ran" << op->description();
+        const qint64 elapsed = timer.nsecsElapsed();
+        if (op->hasParams()) {
+            if (benchmarks)
+                m_timings[op->type()].push_back(elapsed);
+            else
+                qDebug() << "Ran" << op->description();
+        }
         QTest::qWait(m_operationDelayMS);
         DockRegistry::self()->checkSanityAll();
     }
@@ -323,8 +336,10 @@ void Fuzzer::fuzz(const QStringList &jsonFiles)
         qFatal("Use -d only when passing a single json file");
     }
 
-    for (const QString &jsonFile : jsonFiles)
-        fuzz(jsonFile);
+    for (int i = 0; i < m_repetitions; ++i) {
+        for (const QString &jsonFile : jsonFiles)
+            fuzz(jsonFile);
+    }
 }
 
 void Fuzzer::fuzz(const QString &jsonFile)
@@ -381,6 +396,74 @@ void Fuzzer::setLastSavedLayout(const QByteArray &serialized)
     m_lastSavedLayout = serialized;
 }
 
+void Fuzzer::setRepetitions(int repetitions)
+{
+    m_repetitions = qMax(1, repetitions);
+}
+
+/// @brief Returns the nearest-rank percentile @p p of the sorted @p samples
+static qint64 percentile(const QVector<qint64> &samples, double p)
+{
+    const int rank = int(std::ceil(p / 100.0 * samples.size()));
+    return samples.at(qBound(0, rank - 1, samples.size() - 1));
+}
+
+QVariantMap Fuzzer::benchmarkResults() const
+{
+    QVariantMap results;
+    const QMetaEnum metaEnum = QMetaEnum::fromType<OperationType>();
+    for (auto it = m_timings.cbegin(), end = m_timings.cend(); it != end; ++it) {
+        QVector<qint64> samples = it.value();
+        std::sort(samples.begin(), samples.end());
+
+        QVariantMap map;
+        map[QStringLiteral("count")] = samples.size();
+        map[QStringLiteral("min")] = samples.first() / 1000.0;
+        map[QStringLiteral("p50")] = percentile(samples, 50) / 1000.0;
+        map[QStringLiteral("p90")] = percentile(samples, 90) / 1000.0;
+        map[QStringLiteral("p99")] = percentile(samples, 99) / 1000.0;
+        map[QStringLiteral("max")] = samples.last() / 1000.0;
+
+        QString name = QString::fromLatin1(metaEnum.valueToKey(it.key()));
+        name.remove(QStringLiteral("OperationType_"));
+        results[name] = map;
+    }
+
+    return results;
+}
+
+void Fuzzer::printBenchmarkResults() const
+{
+    const QVariantMap results = benchmarkResults();
+    qDebug().noquote() << QStringLiteral("\nLatencies in microseconds, %1 repetition(s):").arg(m_repetitions);
+    qDebug().noquote() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+                          .arg(QStringLiteral("Operation"), -25).arg(QStringLiteral("count"), 8)
+                          .arg(QStringLiteral("min"), 10).arg(QStringLiteral("p50"), 10)
+                          .arg(QStringLiteral("p90"), 10).arg(QStringLiteral("p99"), 10)
+                          .arg(QStringLiteral("max"), 10);
+
+    for (auto it = results.cbegin(), end = results.cend(); it != end; ++it) {
+        const QVariantMap map = it.value().toMap();
+        qDebug().noquote() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+                              .arg(it.key(), -25).arg(map["count"].toInt(), 8)
+                              .arg(map["min"].toDouble(), 10, 'f', 1).arg(map["p50"].toDouble(), 10, 'f', 1)
+                              .arg(map["p90"].toDouble(), 10, 'f', 1).arg(map["p99"].toDouble(), 10, 'f', 1)
+                              .arg(map["max"].toDouble(), 10, 'f', 1);
+    }
+}
+
+bool Fuzzer::dumpBenchmarkResults(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << Q_FUNC_INFO << "Error opening file" << filename;
+        return false;
+    }
+
+    file.write(QJsonDocument::fromVariant(benchmarkResults()).toJson());
+    return true;
+}
+
 void Fuzzer::Test::dumpToJsonFile(const QString &filename) const
 {
     const QVariantMap map = toVariantMap();
@@ -29,6 +29,7 @@
 #include "Operations.h"
 
 #include <QJsonDocument>
+#include <QMap>
 #include <QVector>
 
 #include <random>
@@ -73,7 +74,8 @@ public:
     enum Option {
         Option_None = 0,
         Option_NoQuit = 1, ///< Don't quit when the tests finish. So we can debug in gammaray
-        Option_SkipLast = 2 ///< Don't execute the last test. Useful when the last one is the failing one and we want to inspect the state prior to crash
+        Option_SkipLast = 2, ///< Don't execute the last test. Useful when the last one is the failing one and we want to inspect the state prior to crash
+        Option_Benchmark = 4 ///< Times each operation, so replaying the testcases doubles as a performance regression suite
     };
     Q_DECLARE_FLAGS(Options, Option)
 
@@ -270,6 +272,18 @@ public:
     QByteArray lastSavedLayout() const;
     void setLastSavedLayout(const QByteArray &serialized);
 
+    ///@brief Sets how many times each json file is replayed. Only useful with Option_Benchmark.
+    void setRepetitions(int);
+
+    ///@brief Returns the latency percentiles of each operation type, in microseconds
+    QVariantMap benchmarkResults() const;
+
+    ///@brief Prints the results of Option_Benchmark as a table
+    void printBenchmarkResults() const;
+
+    ///@brief Writes the results of Option_Benchmark to a json file
+    bool dumpBenchmarkResults(const QString &filename) const;
+
 private:
     std::random_device m_randomDevice;
     std::mt19937 m_randomEngine;
@@ -279,6 +293,8 @@ private:
     int m_operationDelayMS = 50;
     const Options m_options;
     QByteArray m_lastSavedLayout;
+    int m_repetitions = 1;
+    QMap<Operations::OperationType, QVector<qint64>> m_timings; // nsecs, per execution
 };
 
 }
@@ -57,6 +57,15 @@ int main(int argc, char **argv)
     QCommandLineOption noQuitOption("n", QCoreApplication::translate("main", "Don't quit at the end, keep event loop running for debugging"));
     parser.addOption(noQuitOption);
 
+    QCommandLineOption benchmarkOption("p", QCoreApplication::translate("main", "Performance replay. Times each operation and prints latency percentiles per operation type"));
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption repetitionsOption("r", QCoreApplication::translate("main", "Replays the json files <n> times, for more stable benchmark results"), "n", "1");
+    parser.addOption(repetitionsOption);
+
+    QCommandLineOption benchmarkOutputOption("o", QCoreApplication::translate("main", "Also writes the benchmark results to the json <file>"), "file");
+    parser.addOption(benchmarkOutputOption);
+
     parser.addHelpOption();
     parser.process(app);
 
@@ -74,11 +83,20 @@ int main(int argc, char **argv)
     if (parser.isSet(noQuitOption))
         options |= Fuzzer::Option_NoQuit;
 
+    const bool benchmarks = parser.isSet(benchmarkOption);
+    if (benchmarks)
+        options |= Fuzzer::Option_Benchmark;
+
     const bool loops = parser.isSet(loopOption);
 
     Fuzzer fuzzer(dumpToJsonOnFatal, options);
     if (slowDown)
         fuzzer.setDelayBetweenOperations(1000);
+    else if (benchmarks)
+        fuzzer.setDelayBetweenOperations(0); // The delay isn't timed, but no point in waiting either
+
+    fuzzer.setRepetitions(parser.value(repetitionsOption).toInt());
+    const QString benchmarkOutput = parser.value(benchmarkOutputOption);
 
     for (const QString &file : filesToLoad) {
         if (!QFile::exists(file)) {
@@ -87,7 +105,7 @@ int main(int argc, char **argv)
         }
     }
 
-    QTimer::singleShot(0, &fuzzer, [&app, &fuzzer, filesToLoad, loops, options] {
+    QTimer::singleShot(0, &fuzzer, [&app, &fuzzer, filesToLoad, loops, options, benchmarkOutput] {
         if (filesToLoad.isEmpty()) {
             do {
                 fuzzer.fuzz({ 1, 10, true });
@@ -96,6 +114,12 @@ int main(int argc, char **argv)
             fuzzer.fuzz(filesToLoad);
         }
 
+        if (options & Fuzzer::Option_Benchmark) {
+            fuzzer.printBenchmarkResults();
+            if (!benchmarkOutput.isEmpty())
+                fuzzer.dumpBenchmarkResults(benchmarkOutput);
+        }
+
         if (!(options & Fuzzer::Option_NoQuit)) {
             // if noQuit is true we keep the app running so it can be debugged
             app.quit();
@@ -24,6 +24,8 @@
 #include "DockWidgetBase.h"
 #include "MainWindow.h"
 #include "FloatingWindow_p.h"
+#include "FloatingWindowPool_p.h"
+#include "HibernationManager_p.h"
 #include "DockRegistry_p.h"
 #include "Frame_p.h"
 #include "private/widgets/FrameWidget_p.h"
@@ -35,14 +37,17 @@
 #include "LayoutSaver_p.h"
 #include "TabWidget_p.h"
 #include "multisplitter/MultiSplitter_p.h"
+#include "multisplitter/LazyResizePreview_p.h"
 #include "LastPosition_p.h"
 #include "utils.h"
 #include "FrameworkWidgetFactory.h"
 #include "DropAreaWithCentralFrame_p.h"
+#include "indicators/ClassicIndicators_p.h"
 #include "Testing.h"
 
 #include <QtTest/QtTest>
 #include <QPainter>
+#include <QPixmapCache>
 #include <QApplication>
 #include <QTabBar>
 #include <QAction>
@@ -52,6 +57,9 @@
 #include <QVBoxLayout>
 #include <QToolButton>
 #include <QStyleFactory>
+#include <QTemporaryDir>
+
+#include <functional>
 
 #ifdef Q_OS_WIN
 # include <Windows.h>
@@ -205,6 +213,10 @@ struct EnsureTopLevelsDeleted
         Config::self().setFlags(m_originalFlags);
         Config::self().setSeparatorThickness(m_originalStaticAnchorThickness, true);
         Config::self().setSeparatorThickness(m_originalAnchorThickness, false);
+        Config::self().setMaxPlaceholdersPerLayout(-1);
+        Config::self().setTabHibernationTimeout(-1);
+        Config::self().setMaxInactiveTabsMemory(-1);
+        Config::self().setDragHoverInterval(-1);
     }
 
     QWidgetList topLevels() const
@@ -271,6 +283,7 @@ private Q_SLOTS:
     void tst_notClosable();
     void tst_maximizeAndRestore();
     void tst_propagateResize2();
+    void tst_propagateResizeFanOut();
 
     void tst_availableLengthForDrop_data();
     void tst_availableLengthForDrop();
@@ -339,11 +352,18 @@ private Q_SLOTS:
     void tst_marginsAfterRestore();
     void tst_restoreEmbeddedMainWindow();
     void tst_restoreWithDockFactory();
+    void tst_restoreIncremental();
+    void tst_restoreBinary();
+    void tst_restoreFromFileAsync();
+    void tst_serializeCache();
 
     void tst_resizeWindow_data();
     void tst_resizeWindow();
     void tst_resizeWindow2();
     void tst_rectForDropCrash();
+    void tst_rectForDropCache();
+    void tst_sharedIndicatorWindow();
+    void tst_dragHoverCoalescing();
 
     void tst_tabBarWithHiddenTitleBar_data();
     void tst_tabBarWithHiddenTitleBar();
@@ -354,12 +374,27 @@ private Q_SLOTS:
 
     void tst_addToHiddenMainWindow();
     void tst_minSizeChanges();
+    void tst_cumulativeMinLengthCache();
+    void tst_incrementalMinSize();
+    void tst_geometryTransaction();
+    void tst_itemAt();
+    void tst_lightweightSeparators();
+    void tst_coalesceResizes();
+    void tst_lazyResize();
+    void tst_layoutSolver();
+    void tst_layoutSolverTopology();
+    void tst_layoutStats();
+    void tst_addDockWidgets();
+    void tst_widgetFactory();
+    void tst_tabHibernation();
     void tst_complex();
     void tst_titlebar_getter();
     void tst_staticAnchorThickness_data();
     void tst_staticAnchorThickness();
     void tst_honourGeometryOfHiddenWindow();
     void tst_registry();
+    void tst_floatingWindowPool();
+    void tst_placeholderBudget();
     void tst_dockNotFillingSpace();
     void tst_floatingLastPosAfterDoubleClose();
     void tst_addingOptionHiddenTabbed();
@@ -2087,6 +2122,91 @@ void TestDocks::tst_propagateResize2()
     dropArea->checkSanity();
 }
 
+void TestDocks::tst_propagateResizeFanOut()
+{
+    // Tests that propagateResize() moves the anchors like enumerating every path would, in a
+    // layout with many routes of the same length to the border
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(1600, 1000), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    for (int i = 0; i < 4; ++i) {
+        auto column = createDockWidget(QStringLiteral("column%1").arg(i), new QPushButton("c"));
+        m->addDockWidget(column, Location_OnRight);
+        for (int j = 0; j < 2; ++j) {
+            auto row = createDockWidget(QStringLiteral("row%1-%2").arg(i).arg(j), new QPushButton("r"));
+            m->addDockWidget(row, Location_OnBottom, column);
+            auto cell = createDockWidget(QStringLiteral("cell%1-%2").arg(i).arg(j), new QPushButton("c"));
+            m->addDockWidget(cell, Location_OnRight, row);
+        }
+    }
+    QVERIFY(layout->checkSanity());
+
+    // What the exhaustive algorithm did: the smallest paths contribute first and each anchor
+    // contributes once
+    auto expectedPositions = [layout] (int delta, Anchor *fromAnchor, Anchor::Side direction) {
+        QVector<Anchor::List> paths;
+        std::function<void(Anchor *, Anchor::List)> collect = [&] (Anchor *anchor, Anchor::List path) {
+            if (anchor->isStatic()) {
+                paths.push_back(path);
+                return;
+            }
+            path.push_back(anchor);
+            const ItemList items = anchor->items(direction);
+            if (items.isEmpty())
+                paths.push_back(path);
+            for (Item *item : items)
+                collect(item->anchorAtSide(direction, anchor->orientation()), path);
+        };
+        collect(fromAnchor, {});
+        std::stable_sort(paths.begin(), paths.end(), [] (const Anchor::List &p1, const Anchor::List &p2) {
+            return p1.size() < p2.size();
+        });
+
+        const int sign = direction == Anchor::Side1 ? -1 : 1;
+        QHash<Anchor*, int> result;
+        for (const Anchor::List &path : qAsConst(paths)) {
+            if (path.size() <= 1)
+                continue;
+            const int contribution = (delta / (path.size() - 1)) * sign;
+            if (qAbs(contribution) < 5)
+                continue;
+            for (int i = 1; i < path.size(); ++i) {
+                Anchor *a = path.at(i);
+                if (result.contains(a))
+                    continue;
+                const int bound = layout->boundPositionForAnchor(a, direction);
+                const int pos = sign < 0 ? qMax(a->position() + contribution, bound)
+                                         : qMin(a->position() + contribution, bound);
+                if (pos != a->position())
+                    result.insert(a, pos);
+            }
+        }
+
+        return result;
+    };
+
+    int numMoved = 0;
+    for (Qt::Orientation orientation : { Qt::Vertical, Qt::Horizontal }) {
+        for (Anchor::Side direction : { Anchor::Side2, Anchor::Side1 }) {
+            for (Anchor *fromAnchor : layout->anchors(orientation, /*includeStatic=*/ false)) {
+                const QHash<Anchor*, int> expected = expectedPositions(60, fromAnchor, direction);
+                QHash<Anchor*, int> before;
+                for (Anchor *a : layout->anchors())
+                    before.insert(a, a->position());
+
+                layout->propagateResize(60, fromAnchor, direction);
+                for (Anchor *a : layout->anchors())
+                    QCOMPARE(a->position(), expected.value(a, before.value(a)));
+                numMoved += expected.size();
+            }
+        }
+    }
+
+    QVERIFY(numMoved > 0);
+    QVERIFY(layout->checkSanity());
+}
+
 std::unique_ptr<MultiSplitter> TestDocks::createMultiSplitterFromSetup(MultiSplitterSetup setup, QHash<QWidget*, Frame*> &frameMap) const
 {
     auto widget = std::unique_ptr<MultiSplitter>(new MultiSplitter());
@@ -4277,6 +4397,548 @@ void TestDocks::tst_minSizeChanges()
     delete m;
 }
 
+void TestDocks::tst_cumulativeMinLengthCache()
+{
+    // Tests that the memoized cumulative min lengths are invalidated when a min size changes
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto w1 = new MyWidget2(QSize(100, 100));
+    auto d1 = createDockWidget("1", w1);
+    auto d2 = createDockWidget("2", new MyWidget2(QSize(100, 100)));
+    m->addDockWidget(d1, Location_OnLeft);
+    m->addDockWidget(d2, Location_OnRight);
+    auto layout = m->multiSplitterLayout();
+
+    Item *item1 = layout->itemForFrame(d1->frame());
+    Anchor *anchor = item1->anchorGroup().right;
+    QVERIFY(!anchor->isStatic());
+
+    const QPair<int, int> bounds = layout->boundPositionsForAnchor(anchor);
+    QCOMPARE(layout->boundPositionsForAnchor(anchor), bounds);
+    QVERIFY(!layout->m_cumulativeMinLengthCache.isEmpty());
+
+    w1->setMinSize(QSize(200, 100));
+    QTRY_COMPARE(layout->boundPositionsForAnchor(anchor).first, bounds.first + 100);
+    QCOMPARE(layout->boundPositionsForAnchor(anchor).second, bounds.second);
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_incrementalMinSize()
+{
+    // Tests that a min size change only invalidates the memoized lengths of the affected anchor chains
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto w1 = new MyWidget2(QSize(100, 100));
+    auto d1 = createDockWidget("1", w1);
+    auto d2 = createDockWidget("2", new MyWidget2(QSize(100, 100)));
+    auto d3 = createDockWidget("3", new MyWidget2(QSize(100, 100)));
+    m->addDockWidget(d1, Location_OnLeft);
+    m->addDockWidget(d2, Location_OnRight);
+    m->addDockWidget(d3, Location_OnBottom);
+    auto layout = m->multiSplitterLayout();
+
+    layout->updateSizeConstraints();
+    const auto topKey = qMakePair<const Anchor*, int>(layout->m_topAnchor, int(Anchor::Side2));
+    const auto leftKey = qMakePair<const Anchor*, int>(layout->m_leftAnchor, int(Anchor::Side2));
+    QVERIFY(layout->m_cumulativeMinLengthCache.contains(topKey));
+    QVERIFY(layout->m_cumulativeMinLengthCache.contains(leftKey));
+
+    // A width change only affects the chains of vertical anchors
+    Item *item1 = layout->itemForFrame(d1->frame());
+    layout->invalidateCumulativeMinLengthCache(item1, Qt::Vertical);
+    QVERIFY(layout->m_cumulativeMinLengthCache.contains(topKey));
+    QVERIFY(!layout->m_cumulativeMinLengthCache.contains(leftKey));
+
+    // And the result matches a full recalculation
+    w1->setMinSize(QSize(300, 100));
+    QTRY_VERIFY(item1->minimumSize().width() >= 300);
+    const QSize incrementalMinSize = layout->minimumSize();
+    layout->invalidateCumulativeMinLengthCache();
+    layout->updateSizeConstraints();
+    QCOMPARE(layout->minimumSize(), incrementalMinSize);
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_geometryTransaction()
+{
+    // Tests that frames are only resized once, when the outermost transaction is committed
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto d1 = createDockWidget("1", new MyWidget2(QSize(100, 100)));
+    auto d2 = createDockWidget("2", new MyWidget2(QSize(100, 100)));
+    m->addDockWidget(d1, Location_OnLeft);
+    m->addDockWidget(d2, Location_OnRight);
+    auto layout = m->multiSplitterLayout();
+
+    Item *item1 = layout->itemForFrame(d1->frame());
+    Anchor *anchor = item1->anchorGroup().right;
+    QVERIFY(!anchor->isStatic());
+    const int oldPos = anchor->position();
+    const QRect oldFrameGeo = d1->frame()->geometry();
+    QSignalSpy spy(item1, &Item::geometryChanged);
+
+    layout->beginGeometryTransaction();
+    layout->beginGeometryTransaction();
+    anchor->setPosition(oldPos - 20);
+    anchor->setPosition(oldPos - 10);
+    QCOMPARE(item1->width(), oldFrameGeo.width() - 10);
+    QCOMPARE(d1->frame()->geometry(), oldFrameGeo);
+
+    layout->commitGeometryTransaction();
+    QVERIFY(layout->isInGeometryTransaction());
+    QCOMPARE(d1->frame()->geometry(), oldFrameGeo);
+    QCOMPARE(spy.count(), 0);
+
+    layout->commitGeometryTransaction();
+    QVERIFY(!layout->isInGeometryTransaction());
+    QCOMPARE(d1->frame()->geometry(), item1->geometry());
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_itemAt()
+{
+    // Tests that the grid behind itemAt() agrees with the item geometries, including after changes
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    DockWidgetBase::List docks;
+    for (int i = 0; i < 7; ++i) {
+        auto dw = createDockWidget(QStringLiteral("dw%1").arg(i), new QPushButton());
+        m->addDockWidget(dw, i % 2 ? Location_OnBottom : Location_OnRight);
+        docks << dw;
+    }
+
+    auto check = [layout] {
+        for (Item *item : layout->items()) {
+            if (item->isPlaceholder())
+                continue;
+            const QRect geo = item->geometry();
+            QCOMPARE(layout->itemAt(geo.center()), item);
+            QCOMPARE(layout->itemAt(geo.topLeft()), item);
+            QCOMPARE(layout->itemAt(geo.bottomRight()), item);
+        }
+    };
+
+    check();
+    QCOMPARE(layout->itemAt(QPoint(-1, -1)), nullptr);
+
+    docks.at(3)->close();
+    check();
+    m->resize(QSize(1000, 700));
+    check();
+    docks.at(3)->show();
+    check();
+}
+
+void TestDocks::tst_lightweightSeparators()
+{
+    // Tests that with Flag_LightweightSeparators the MultiSplitter paints and drags the separators
+    EnsureTopLevelsDeleted e;
+    Config::self().setFlags(Config::Flag_LightweightSeparators);
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    QVERIFY(QTest::qWaitForWindowExposed(m->windowHandle()));
+    auto layout = m->multiSplitterLayout();
+    auto dock1 = createDockWidget("dock1", new QPushButton("one"));
+    auto dock2 = createDockWidget("dock2", new QPushButton("two"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    QVERIFY(layout->checkSanity());
+
+    for (Anchor *anchor : layout->anchors())
+        QVERIFY(!anchor->separatorWidget());
+
+    Item *item1 = layout->itemForFrame(dock1->frame());
+    Anchor *anchor = item1->anchorGroup().right;
+    QVERIFY(!anchor->isStatic());
+    QVERIFY(anchor->isVisible());
+    QCOMPARE(layout->anchorAt(anchor->geometry().center()), anchor);
+    QCOMPARE(layout->anchorAt(item1->geometry().center()), nullptr);
+
+    // Drag it 50px to the left. Go through QPA, as Anchor::onMouseMoved() checks the button state.
+    QWindow *window = m->windowHandle();
+    const QPoint pressPos = layout->multiSplitter()->mapTo(m.get(), anchor->geometry().center());
+    const QPoint releasePos = pressPos - QPoint(50, 0);
+    const int oldPosition = anchor->position();
+    QTest::mousePress(window, Qt::LeftButton, Qt::NoModifier, pressPos);
+    QVERIFY(anchor->isBeingDragged());
+    QTest::mouseMove(window, releasePos);
+    QTest::mouseRelease(window, Qt::LeftButton, Qt::NoModifier, releasePos);
+    QVERIFY(!anchor->isBeingDragged());
+    QCOMPARE(anchor->position(), oldPosition - 50);
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_coalesceResizes()
+{
+    // Tests that with Flag_CoalesceResizes only the last of several resizes is laid out, and later
+    EnsureTopLevelsDeleted e;
+    Config::self().setFlags(Config::Flag_CoalesceResizes);
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    QVERIFY(QTest::qWaitForWindowExposed(m->windowHandle()));
+    auto layout = m->multiSplitterLayout();
+    auto dock1 = createDockWidget("dock1", new QPushButton("one"));
+    auto dock2 = createDockWidget("dock2", new QPushButton("two"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnBottom);
+    const QSize oldSize = layout->size();
+
+    MultiSplitter *multiSplitter = layout->multiSplitter();
+    const QSize oldWindowSize = m->size();
+    m->resize(oldWindowSize + QSize(10, 10));
+    m->resize(oldWindowSize + QSize(20, 20));
+    m->resize(oldWindowSize + QSize(30, 30));
+    QCOMPARE(layout->size(), oldSize);
+
+    QTRY_COMPARE(layout->size(), multiSplitter->size());
+    QCOMPARE(layout->size(), oldSize + QSize(30, 30));
+    QVERIFY(layout->checkSanity());
+
+    // Operations on the layout apply the pending size first
+    m->resize(oldWindowSize);
+    auto dock3 = createDockWidget("dock3", new QPushButton("three"));
+    m->addDockWidget(dock3, Location_OnRight);
+    QCOMPARE(layout->size(), multiSplitter->size());
+    QVERIFY(layout->checkSanity());
+
+    // A restore discards the pending size, otherwise it would override the restored geometry
+    LayoutSaver saver(RestoreOption_Incremental);
+    const QByteArray saved = saver.serializeLayout();
+    layout->requestSize(layout->size() + QSize(50, 50));
+    QVERIFY(saver.restoreLayout(saved));
+    const QSize restoredSize = layout->size();
+    QTest::qWait(50); // let the 0 timer run
+    QCOMPARE(layout->size(), restoredSize);
+    QCOMPARE(layout->size(), multiSplitter->size());
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_lazyResize()
+{
+    // Tests that with Flag_LazyResize frames are only resized when the separator is released
+    EnsureTopLevelsDeleted e;
+    Config::self().setFlags(Config::Flag_LazyResize);
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    QVERIFY(QTest::qWaitForWindowExposed(m->windowHandle()));
+    auto layout = m->multiSplitterLayout();
+    auto dock1 = createDockWidget("dock1", new QPushButton("one"));
+    auto dock2 = createDockWidget("dock2", new QPushButton("two"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    QVERIFY(!layout->m_lazyResizePreview); // Only created when needed
+
+    Anchor *anchor = layout->itemForFrame(dock1->frame())->anchorGroup().right;
+    QWindow *window = m->windowHandle();
+    const QPoint pressPos = layout->multiSplitter()->mapTo(m.get(), anchor->geometry().center());
+    const QPoint releasePos = pressPos - QPoint(50, 0);
+    const int oldPosition = anchor->position();
+    const QRect oldFrameGeometry = dock1->frame()->geometry();
+
+    QTest::mousePress(window, Qt::LeftButton, Qt::NoModifier, pressPos);
+    QTest::mouseMove(window, releasePos);
+    QVERIFY(layout->m_lazyResizePreview);
+    QVERIFY(layout->m_lazyResizePreview->isVisible());
+    QCOMPARE(anchor->position(), oldPosition);
+    QCOMPARE(dock1->frame()->geometry(), oldFrameGeometry);
+
+    QTest::mouseRelease(window, Qt::LeftButton, Qt::NoModifier, releasePos);
+    QVERIFY(!layout->m_lazyResizePreview->isVisible());
+    QCOMPARE(anchor->position(), oldPosition - 50);
+    QCOMPARE(dock1->frame()->width(), oldFrameGeometry.width() - 50);
+    QVERIFY(layout->checkSanity());
+}
+
+void TestDocks::tst_layoutSolver()
+{
+    // Tests that the widget-free LayoutSolver agrees with MultiSplitterLayout
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    DockWidgetBase::List docks;
+    for (int i = 0; i < 6; ++i) {
+        auto dw = createDockWidget(QStringLiteral("dw%1").arg(i), new QPushButton());
+        m->addDockWidget(dw, i % 2 ? Location_OnBottom : Location_OnRight);
+        docks << dw;
+    }
+    docks.at(2)->close(); // Have some placeholders and followers too
+
+    LayoutSolver solver(layout->toLayoutModel());
+    QCOMPARE(solver.minimumSize(), layout->minimumSize());
+    const Anchor::List anchors = layout->anchors();
+    for (int i = 0; i < anchors.size(); ++i) {
+        const QPair<int, int> expected = layout->boundPositionsForAnchor(anchors.at(i));
+        QCOMPARE(solver.boundPositions(i).first, expected.first);
+        QCOMPARE(solver.boundPositions(i).second, expected.second);
+    }
+
+    auto compare = [layout] (const LayoutModel &model) {
+        const Anchor::List anchors = layout->anchors();
+        for (int i = 0; i < anchors.size(); ++i)
+            QCOMPARE(model.anchors.at(i).position, anchors.at(i)->position());
+        const ItemList items = layout->items();
+        for (int i = 0; i < items.size(); ++i) {
+            if (!items.at(i)->isPlaceholder())
+                QCOMPARE(model.items.at(i).geometry, items.at(i)->geometry());
+        }
+    };
+
+    // Resizing
+    const QSize newSize = layout->size() + QSize(200, 100);
+    QVERIFY(solver.resize(newSize));
+    layout->setSize(newSize);
+    compare(solver.model());
+    QVERIFY(!solver.resize(QSize(1, 1)));
+
+    // Moving an anchor in the model and applying it to the layout
+    int anchorIndex = -1;
+    for (int i = 0; i < anchors.size(); ++i) {
+        if (!anchors.at(i)->isStatic() && !anchors.at(i)->isFollowing()) {
+            anchorIndex = i;
+            break;
+        }
+    }
+    QVERIFY(anchorIndex != -1);
+    const QPair<int, int> bounds = solver.boundPositions(anchorIndex);
+    QVERIFY(!solver.moveAnchor(anchorIndex, bounds.second + 1));
+    QVERIFY(solver.moveAnchor(anchorIndex, bounds.first));
+    QVERIFY(layout->applyLayoutModel(solver.model()));
+    compare(solver.model());
+    QVERIFY(layout->checkSanity());
+
+    delete docks.at(2);
+}
+
+void TestDocks::tst_layoutSolverTopology()
+{
+    // Tests that adding and removing items in the LayoutSolver does the same as MultiSplitterLayout
+    EnsureTopLevelsDeleted e;
+    auto multisplitter = new MultiSplitter();
+    auto layout = multisplitter->multiSplitterLayout();
+    multisplitter->show();
+    layout->setSize(QSize(800, 500));
+
+    auto compare = [layout] (const LayoutModel &model) {
+        const LayoutModel expected = layout->toLayoutModel();
+        QCOMPARE(model.size, expected.size);
+        QCOMPARE(model.anchors.size(), expected.anchors.size());
+        for (int i = 0; i < expected.anchors.size(); ++i) {
+            QCOMPARE(model.anchors.at(i).position, expected.anchors.at(i).position);
+            QCOMPARE(model.anchors.at(i).from, expected.anchors.at(i).from);
+            QCOMPARE(model.anchors.at(i).to, expected.anchors.at(i).to);
+            QCOMPARE(model.anchors.at(i).followee, expected.anchors.at(i).followee);
+            QCOMPARE(model.anchors.at(i).side1Items, expected.anchors.at(i).side1Items);
+            QCOMPARE(model.anchors.at(i).side2Items, expected.anchors.at(i).side2Items);
+        }
+        QCOMPARE(model.items.size(), expected.items.size());
+        for (int i = 0; i < expected.items.size(); ++i)
+            QCOMPARE(model.items.at(i).geometry, expected.items.at(i).geometry);
+    };
+
+    LayoutSolver solver(layout->toLayoutModel());
+    QList<Frame*> frames;
+    const Location locations[] = { Location_OnLeft, Location_OnBottom, Location_OnRight, Location_OnTop };
+    for (int i = 0; i < 8; ++i) {
+        Frame *frame = createFrameWithWidget(QStringLiteral("frame%1").arg(i), multisplitter, 100 + i * 10);
+        const QSize preferredSize = frame->size();
+        const QSize minSize(widgetMinLength(frame, Qt::Vertical), widgetMinLength(frame, Qt::Horizontal));
+        const Location location = locations[i % 4];
+        const int relativeTo = i % 3 == 2 ? i / 2 : -1;
+
+        layout->addWidget(frame, location, relativeTo == -1 ? nullptr : frames.at(relativeTo));
+        QCOMPARE(solver.addItem(minSize, preferredSize, location, relativeTo), i);
+        compare(solver.model());
+        frames << frame;
+    }
+
+    solver.ensureItemsMinSize();
+    compare(solver.model());
+
+    // Removing items merges the anchors that aren't needed anymore
+    for (int i : { 5, 0, 3 }) {
+        Frame *frame = frames.takeAt(i);
+        solver.removeItem(layout->items().indexOf(layout->itemForFrame(frame)));
+        delete layout->itemForFrame(frame);
+        compare(solver.model());
+    }
+
+    QVERIFY(layout->checkSanity());
+    delete multisplitter;
+}
+
+void TestDocks::tst_layoutStats()
+{
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    layout->resetStats();
+
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+
+    const LayoutStats &stats = layout->stats();
+    QCOMPARE(stats.counter(LayoutStats::Operation_AddWidget).count, quint64(2));
+    QVERIFY(stats.counter(LayoutStats::Operation_FrameGeometryUpdate).count > 0);
+    QVERIFY(stats.counter(LayoutStats::Operation_AddWidget).totalNSecs >= stats.counter(LayoutStats::Operation_AddWidget).maxNSecs);
+
+    layout->resetStats();
+    QCOMPARE(stats.counter(LayoutStats::Operation_AddWidget).count, quint64(0));
+
+    Anchor *anchor = layout->anchors(Qt::Vertical, /*includeStatic=*/ false).first();
+    anchor->setPosition(anchor->position() - 10);
+    QVERIFY(stats.counter(LayoutStats::Operation_AnchorSetPosition).count >= 1);
+
+    dock2->close();
+    dock2->show();
+    QCOMPARE(stats.counter(LayoutStats::Operation_RestorePlaceholder).count, quint64(1));
+    QVERIFY(!stats.toString().isEmpty());
+}
+
+void TestDocks::tst_addDockWidgets()
+{
+    // Tests that adding in a batch results in the same layout as adding one by one, with less work
+    EnsureTopLevelsDeleted e;
+    auto m1 = createMainWindow(QSize(800, 500), MainWindowOption_None, "m1");
+    auto m2 = createMainWindow(QSize(800, 500), MainWindowOption_None, "m2");
+    auto layout1 = m1->multiSplitterLayout();
+    auto layout2 = m2->multiSplitterLayout();
+
+    layout1->resetStats();
+    const Location locations[] = { Location_OnLeft, Location_OnRight, Location_OnBottom, Location_OnTop };
+    QVector<DockWidgetBase*> docks1;
+    QVector<MainWindowBase::DockWidgetInsertion> insertions;
+    for (int i = 0; i < 8; ++i) {
+        auto dock1 = createDockWidget(QStringLiteral("a%1").arg(i), new QPushButton("1"));
+        auto dock2 = createDockWidget(QStringLiteral("b%1").arg(i), new QPushButton("2"));
+        const Location location = locations[i % 4];
+        // Every other one is relative to the previous dock widget
+        m1->addDockWidget(dock1, location, i % 2 ? docks1.last() : nullptr);
+        insertions.push_back({ dock2, location, i % 2 ? insertions.last().dockWidget : nullptr, AddingOption_None });
+        docks1.push_back(dock1);
+    }
+
+    layout2->resetStats();
+    QSignalSpy spy(layout2, &MultiSplitterLayout::widgetCountChanged);
+    m2->addDockWidgets(insertions);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(layout2->count(), layout1->count());
+    QCOMPARE(layout2->minimumSize(), layout1->minimumSize());
+    QVERIFY(layout2->checkSanity());
+
+    for (int i = 0; i < insertions.size(); ++i)
+        QCOMPARE(insertions.at(i).dockWidget->frame()->geometry(), docks1.at(i)->frame()->geometry());
+
+    // Frames were resized at the end, instead of on every insertion
+    QVERIFY(layout2->stats().counter(LayoutStats::Operation_FrameGeometryUpdate).count <
+            layout1->stats().counter(LayoutStats::Operation_FrameGeometryUpdate).count);
+}
+
+void TestDocks::tst_widgetFactory()
+{
+    // Tests that the guest widget is only created once the dock widget is seen
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow();
+    auto dock1 = createDockWidget("dock1", new QPushButton("one"));
+    int numCreated = 0;
+    auto dock2 = new DockWidget("dock2");
+    dock2->setWidgetFactory([&numCreated] {
+        numCreated++;
+        return new QPushButton("two");
+    });
+
+    m->addDockWidget(dock1, Location_OnLeft);
+    dock1->addDockWidgetAsTab(dock2);
+    dock1->setAsCurrentTab();
+    QVERIFY(dock1->isCurrentTab());
+    QVERIFY(!dock2->widget());
+    QCOMPARE(numCreated, 0);
+
+    // Becoming current creates it, only once
+    dock2->setAsCurrentTab();
+    QCOMPARE(numCreated, 1);
+    QVERIFY(qobject_cast<QPushButton*>(dock2->widget()));
+    dock1->setAsCurrentTab();
+    dock2->setAsCurrentTab();
+    QCOMPARE(numCreated, 1);
+
+    // A closed dock widget creates it when shown
+    auto dock3 = new DockWidget("dock3");
+    dock3->setWidgetFactory([] { return new QPushButton("three"); });
+    QVERIFY(!dock3->widget());
+    dock3->show();
+    QVERIFY(dock3->widget());
+    delete dock3->window();
+}
+
+void TestDocks::tst_tabHibernation()
+{
+    // Tests that non-current tabs hibernate in LRU order when over the memory budget
+    EnsureTopLevelsDeleted e;
+    Config::self().setMaxInactiveTabsMemory(250);
+    auto manager = HibernationManager::self();
+    auto m = createMainWindow();
+
+    QStringList hibernated;
+    DockWidgetBase::List docks;
+    for (int i = 0; i < 4; ++i) {
+        auto dock = createDockWidget(QStringLiteral("dock%1").arg(i), new QPushButton("hello"));
+        dock->setMemoryCost(100);
+        dock->setHibernationCallbacks([&hibernated, dock] (QWidget *) {
+            hibernated << dock->uniqueName();
+        }, [&hibernated, dock] (QWidget *) {
+            hibernated.removeAll(dock->uniqueName());
+        });
+        docks << dock;
+    }
+
+    m->addDockWidget(docks.at(0), Location_OnLeft);
+    for (int i = 1; i < 4; ++i) {
+        docks.at(0)->addDockWidgetAsTab(docks.at(i));
+        docks.at(i)->setAsCurrentTab();
+    }
+
+    // dock3 is current. 0, 1 and 2 were current in that order, so dock0 is the least recently used
+    QCOMPARE(hibernated, QStringList() << "dock0");
+    QVERIFY(docks.at(0)->isHibernating());
+    QCOMPARE(manager->numInactive(), 2);
+    QCOMPARE(manager->inactiveMemory(), qint64(200));
+    QCOMPARE(manager->hibernatedMemory(), qint64(100));
+
+    // Making it current wakes it up, and pushes out the next least recently used
+    docks.at(0)->setAsCurrentTab();
+    QVERIFY(!docks.at(0)->isHibernating());
+    QCOMPARE(hibernated, QStringList() << "dock1");
+
+    // A per dock widget timeout takes effect right away
+    docks.at(2)->setHibernationTimeout(0);
+    QVERIFY(docks.at(2)->isHibernating());
+    QVERIFY(!docks.at(3)->isHibernating());
+    QCOMPARE(manager->numHibernated(), 2);
+
+    // Opting in while already being a non-current tab
+    auto dock4 = createDockWidget(QStringLiteral("dock4"), new QPushButton("hello"));
+    docks.at(0)->addDockWidgetAsTab(dock4);
+    docks.at(0)->setAsCurrentTab();
+    dock4->setMemoryCost(100);
+    dock4->setHibernationCallbacks([&hibernated] (QWidget *) {
+        hibernated << QStringLiteral("dock4");
+    }, [&hibernated] (QWidget *) {
+        hibernated.removeAll(QStringLiteral("dock4"));
+    });
+    QCOMPARE(manager->numInactive(), 2);
+    QCOMPARE(manager->inactiveMemory(), qint64(200));
+
+    // A new budget or global timeout doesn't wait for the next tab change
+    Config::self().setMaxInactiveTabsMemory(150);
+    QVERIFY(docks.at(3)->isHibernating());
+    QVERIFY(!dock4->isHibernating());
+    Config::self().setTabHibernationTimeout(0);
+    QVERIFY(dock4->isHibernating());
+    QCOMPARE(manager->numInactive(), 0);
+    QCOMPARE(manager->numHibernated(), 4);
+}
+
 void TestDocks::tst_complex()
 {
     // Tests some anchors out of bounds I got
@@ -4426,6 +5088,109 @@ void TestDocks::tst_honourGeometryOfHiddenWindow()
     delete d1->window();
 }
 
+void TestDocks::tst_floatingWindowPool()
+{
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow();
+    auto dock = createDockWidget("dw1", new QPushButton());
+    m->addDockWidget(dock, Location_OnLeft);
+
+    auto pool = FloatingWindowPool::self();
+    Config::self().setFloatingWindowPoolSize(1);
+    QTRY_COMPARE(pool->size(), 1);
+    QVERIFY(DockRegistry::self()->nestedwindows().isEmpty()); // Pooled windows aren't registered
+
+    // Tearing off takes the window from the pool, which is then refilled
+    dock->setFloating(true);
+    QVERIFY(dock->isFloating());
+    QCOMPARE(pool->size(), 0);
+    FloatingWindow *fw = dock->floatingWindow();
+    QVERIFY(fw);
+    QCOMPARE(DockRegistry::self()->nestedwindows(), QVector<FloatingWindow*>{ fw });
+    QCOMPARE(fw->parentWidget(), m.get());
+    QTRY_COMPARE(pool->size(), 1);
+
+    // Dropping the whole window into the main window empties it
+    dragFloatingWindowTo(fw, m->dropArea(), DropIndicatorOverlayInterface::DropLocation_OutterRight);
+    QVERIFY(!dock->isFloating());
+    QTRY_VERIFY(DockRegistry::self()->nestedwindows().isEmpty());
+    QTRY_COMPARE(pool->size(), 1);
+    QVERIFY(m->multiSplitterLayout()->checkSanity());
+
+    // Closing a floating dock widget leaves a window with just a placeholder, it's cleared and pooled
+    auto dock2 = createDockWidget("dw2", new QPushButton());
+    QTRY_COMPARE(pool->size(), 1);
+    QPointer<FloatingWindow> fw2 = dock2->floatingWindow();
+    QVERIFY(fw2);
+    dock2->close();
+    dock->setFloating(true); // Empties the pool, fw2 should take the free slot instead of a new window
+    QCOMPARE(pool->size(), 0);
+    QTRY_COMPARE(pool->size(), 1);
+    QVERIFY(fw2);
+    QVERIFY(!fw2->isVisible());
+    QCOMPARE(fw2->multiSplitterLayout()->count(), 0);
+    QVERIFY(!dock2->lastPosition()->layoutItem());
+    QVERIFY(!DockRegistry::self()->nestedwindows().contains(fw2));
+
+    // And it's the one handed out next
+    auto dock3 = createDockWidget("dw3", new QPushButton(), {}, /*show=*/ false);
+    dock3->show();
+    QCOMPARE(dock3->morphIntoFloatingWindow(), fw2.data());
+    QCOMPARE(dock3->floatingWindow(), fw2.data());
+    QCOMPARE(fw2->multiSplitterLayout()->count(), 1);
+    QVERIFY(fw2->multiSplitterLayout()->checkSanity());
+
+    Config::self().setFloatingWindowPoolSize(0);
+    QCOMPARE(pool->size(), 0);
+    delete dock->window();
+    delete dock2;
+    delete dock3->window();
+}
+
+void TestDocks::tst_placeholderBudget()
+{
+    // Tests that only the most recently closed dock widgets keep their placeholder
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    DockWidgetBase::List docks;
+    for (int i = 0; i < 5; ++i) {
+        auto dw = createDockWidget(QStringLiteral("dw%1").arg(i), new QPushButton());
+        m->addDockWidget(dw, i % 2 ? Location_OnBottom : Location_OnRight);
+        docks << dw;
+    }
+
+    const int numAnchors = layout->anchors().size();
+    Config::self().setMaxPlaceholdersPerLayout(2);
+    for (int i = 0; i < 4; ++i)
+        docks.at(i)->close();
+
+    QTRY_COMPARE(layout->placeholderCount(), 2);
+    QCOMPARE(layout->count(), 3);
+    QVERIFY(layout->anchors().size() < numAnchors);
+    QVERIFY(layout->checkSanity());
+
+    QVERIFY(!docks.at(0)->lastPosition()->isValid());
+    QVERIFY(!docks.at(1)->lastPosition()->isValid());
+    QVERIFY(docks.at(2)->lastPosition()->isValid());
+    QVERIFY(docks.at(3)->lastPosition()->isValid());
+
+    // The placeholder knows who refs it, that's how compaction releases it
+    Item *placeholder = docks.at(3)->lastPosition()->layoutItem();
+    QCOMPARE(placeholder->lastPositions(), QVector<LastPosition*>({ docks.at(3)->lastPosition() }));
+
+    // The retained ones are still restored to the main window
+    docks.at(3)->show();
+    QVERIFY(!docks.at(3)->isFloating());
+    QCOMPARE(docks.at(3)->window(), m.get());
+    QCOMPARE(layout->placeholderCount(), 1);
+    QVERIFY(layout->checkSanity());
+
+    delete docks.at(0);
+    delete docks.at(1);
+    delete docks.at(2);
+}
+
 void TestDocks::tst_registry()
 {
     EnsureTopLevelsDeleted e;
@@ -4435,9 +5200,21 @@ void TestDocks::tst_registry()
     auto dw = new DockWidget(QStringLiteral("dw1"));
     auto guest = new QWidget();
     dw->setWidget(guest);
+    QCOMPARE(dr->dockWidgetCount(), 1);
     QCOMPARE(dr->dockWidgetForGuest(nullptr), nullptr);
     QCOMPARE(dr->dockWidgetForGuest(guest), dw);
+    QCOMPARE(dr->dockByName(QStringLiteral("dw1")), dw);
+    QCOMPARE(dr->dockByName(QStringLiteral("dw2")), nullptr);
+
+    auto m = new MainWindow(QStringLiteral("m1"));
+    QCOMPARE(dr->mainWindowCount(), 1);
+    QCOMPARE(dr->mainWindowByName(QStringLiteral("m1")), m);
+    delete m;
+    QCOMPARE(dr->mainWindowByName(QStringLiteral("m1")), nullptr);
+
     delete dw;
+    QCOMPARE(dr->dockByName(QStringLiteral("dw1")), nullptr);
+    QCOMPARE(dr->dockWidgetForGuest(guest), nullptr);
 }
 
 void TestDocks::tst_dockNotFillingSpace()
@@ -4507,6 +5284,178 @@ void TestDocks::tst_rectForDropCrash()
     delete m->window();
 }
 
+void TestDocks::tst_rectForDropCache()
+{
+    // Tests that cached rectForDrop() results match the uncached ones, also after the layout changes mid-drag
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto layout = m->multiSplitterLayout();
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    auto dock3 = createDockWidget("3", new QPushButton("3"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    Item *item1 = layout->itemForFrame(dock1->frame());
+
+    const Location locations[] = { Location_OnLeft, Location_OnTop, Location_OnRight, Location_OnBottom };
+    auto uncachedRects = [&] {
+        layout->setRectForDropCacheEnabled(false);
+        QVector<QRect> rects;
+        for (Location location : locations) {
+            rects << layout->rectForDrop(dock3, location, item1);
+            rects << layout->rectForDrop(dock3, location, nullptr);
+        }
+        return rects;
+    };
+
+    auto cachedRects = [&] {
+        layout->setRectForDropCacheEnabled(true);
+        QVector<QRect> rects;
+        for (Location location : locations) {
+            rects << layout->rectForDrop(dock3, location, item1);
+            rects << layout->rectForDrop(dock3, location, nullptr);
+        }
+        return rects;
+    };
+
+    // Twice, so the second time comes from the cache
+    const QVector<QRect> expected = uncachedRects();
+    QCOMPARE(cachedRects(), expected);
+    QVERIFY(!layout->m_rectForDropCache.isEmpty());
+    QCOMPARE(cachedRects(), expected);
+
+    // A layout change while the cache is enabled invalidates it
+    Anchor *anchor = item1->anchorGroup().right;
+    anchor->setPosition(anchor->position() + 50);
+    QVERIFY(layout->m_rectForDropCache.isEmpty());
+    const QVector<QRect> rectsAfterChange = cachedRects();
+    QVERIFY(rectsAfterChange != expected);
+    QCOMPARE(rectsAfterChange, uncachedRects());
+
+    // Disabling clears it
+    cachedRects();
+    layout->setRectForDropCacheEnabled(false);
+    QVERIFY(layout->m_rectForDropCache.isEmpty());
+    delete dock3;
+}
+
+void TestDocks::tst_sharedIndicatorWindow()
+{
+    // Tests that drop indicators are only created when hovered, and that all drop areas share one indicator window
+    EnsureTopLevelsDeleted e;
+    auto indicatorWindows = [] {
+        QWidgetList result;
+        for (QWidget *w : qApp->topLevelWidgets()) {
+            if (qobject_cast<IndicatorWindow*>(w))
+                result << w;
+        }
+        return result;
+    };
+
+    auto m1 = createMainWindow(QSize(800, 500), MainWindowOption_None, "m1");
+    auto m2 = createMainWindow(QSize(800, 500), MainWindowOption_None, "m2");
+    auto dock = createDockWidget("1", new QPushButton("1"));
+    auto fw = dock->floatingWindow();
+    QVERIFY(fw);
+    DropArea *dropArea1 = m1->dropArea();
+    DropArea *dropArea2 = m2->dropArea();
+
+    // Nothing before the first drag
+    QVERIFY(!dropArea1->m_dropIndicatorOverlay);
+    QVERIFY(!dropArea2->m_dropIndicatorOverlay);
+    QVERIFY(!fw->dropArea()->m_dropIndicatorOverlay);
+    QVERIFY(indicatorWindows().isEmpty());
+
+    dropArea1->hover(fw, dropArea1->mapToGlobal(dropArea1->rect().center()));
+    QVERIFY(dropArea1->m_dropIndicatorOverlay);
+    QCOMPARE(indicatorWindows().size(), 1);
+    QWidget *indicatorWindow = indicatorWindows().first();
+    dropArea1->removeHover();
+
+    dropArea2->hover(fw, dropArea2->mapToGlobal(dropArea2->rect().center()));
+    QVERIFY(dropArea2->m_dropIndicatorOverlay);
+    QCOMPARE(indicatorWindows(), QWidgetList() << indicatorWindow);
+
+    // The images are cached per name, translucency and device pixel ratio
+    auto indicator = indicatorWindow->findChildren<Indicator*>().first();
+    indicator->grab();
+    const qreal dpr = indicator->devicePixelRatioF();
+    const QString key = QStringLiteral("kddockwidgets_indicator_%1_%2_%3").arg(indicator->iconName(indicator->m_hovered))
+                        .arg(int(windowManagerHasTranslucency())).arg(dpr);
+    QPixmap pixmap;
+    QVERIFY(QPixmapCache::find(key, &pixmap));
+    QCOMPARE(pixmap.devicePixelRatio(), dpr);
+    dropArea2->removeHover();
+
+    // Freed with the last user
+    QPointer<QWidget> indicatorWindowPtr = indicatorWindow;
+    m1.reset();
+    QVERIFY(indicatorWindowPtr);
+    m2.reset();
+    QVERIFY(!indicatorWindowPtr);
+    QVERIFY(indicatorWindows().isEmpty());
+    delete fw;
+}
+
+void TestDocks::tst_dragHoverCoalescing()
+{
+    // Tests that mouse moves within one dragHoverInterval() result in a single hover, and that
+    // releasing the mouse doesn't drop based on a stale hover
+    EnsureTopLevelsDeleted e;
+    Config::self().setDragHoverInterval(500);
+
+    auto m1 = createMainWindow(QSize(400, 400), MainWindowOption_None, "m1");
+    auto m2 = createMainWindow(QSize(400, 400), MainWindowOption_None, "m2");
+    m1->move(100, 100);
+    m2->move(600, 100);
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    auto dock3 = createDockWidget("3", new QPushButton("3"));
+    m1->addDockWidget(dock1, Location_OnLeft);
+    m2->addDockWidget(dock2, Location_OnLeft);
+    QPointer<FloatingWindow> fw = dock3->floatingWindow();
+    fw->move(100, 600);
+    QTest::qWait(100);
+
+    QWidget *draggable = draggableFor(fw);
+    auto moveTo = [draggable] (QPoint globalPos) {
+        QCursor::setPos(globalPos);
+        QMouseEvent ev(QEvent::MouseMove, draggable->mapFromGlobal(globalPos), draggable->window()->mapFromGlobal(globalPos), globalPos,
+                       Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+        qApp->sendEvent(draggable, &ev);
+    };
+
+    // Start dragging. The first hover is immediate, nothing is under the cursor yet
+    const QPoint pressPos = draggable->mapToGlobal(QPoint(10, 10));
+    pressOn(pressPos, draggable);
+    moveTo(pressPos + QPoint(50, 0));
+    QTest::qWait(10);
+    moveTo(pressPos + QPoint(60, 0));
+
+    // These are all coalesced, so m1 isn't hovered yet
+    const QRect frame1Rect(dock1->frame()->mapToGlobal(QPoint(0, 0)), dock1->frame()->size());
+    moveTo(frame1Rect.topLeft() + QPoint(20, 20));
+    moveTo(frame1Rect.topLeft() + QPoint(40, 40));
+    moveTo(frame1Rect.center());
+    QVERIFY(!m1->dropArea()->m_dropIndicatorOverlay);
+
+    // A single hover, at the last position, once the interval elapses
+    QTRY_VERIFY(m1->dropArea()->m_dropIndicatorOverlay);
+    QCOMPARE(m1->dropArea()->m_dropIndicatorOverlay->hoveredFrame(), dock1->frame());
+    QCOMPARE(m1->dropArea()->m_dropIndicatorOverlay->currentDropLocation(), DropIndicatorOverlayInterface::DropLocation_Center);
+
+    // Move onto m2 and release right away. The pending hover must be flushed so we drop onto m2, not m1
+    moveTo(dock2->frame()->mapToGlobal(dock2->frame()->rect().center()));
+    QVERIFY(!m2->dropArea()->m_dropIndicatorOverlay);
+    releaseOn(dock2->frame()->mapToGlobal(dock2->frame()->rect().center()), draggable);
+
+    QCOMPARE(dock3->window(), m2.get());
+    QCOMPARE(dock3->frame(), dock2->frame());
+    QCOMPARE(m1->dropArea()->m_dropIndicatorOverlay->currentDropLocation(), DropIndicatorOverlayInterface::DropLocation_None);
+    QCOMPARE(dock1->frame()->dockWidgetCount(), 1);
+    QTRY_VERIFY(!fw);
+}
+
 void TestDocks::tst_availableSizeWithPlaceholders()
 {
     // Tests MultiSplitterLayout::available() with and without placeholders. The result should be the same.
@@ -5355,6 +6304,269 @@ void TestDocks::tst_restoreWithDockFactory()
     layout->checkSanity();
 }
 
+void TestDocks::tst_restoreIncremental()
+{
+    // Tests that RestoreOption_Incremental reuses the frames and separators when only sizes changed
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    auto layout = m->multiSplitterLayout();
+
+    Item *item1 = layout->itemForFrame(dock1->frame());
+    QPointer<Anchor> anchor = item1->anchorGroup().right;
+    QPointer<Frame> frame1 = dock1->frame();
+    QPointer<Frame> frame2 = dock2->frame();
+    const int savedPos = anchor->position();
+
+    LayoutSaver saver(RestoreOption_Incremental);
+    const QByteArray saved = saver.serializeLayout();
+    LayoutSaver::Layout savedLayout;
+    QVERIFY(savedLayout.fromJson(saved));
+    QVERIFY(layout->matchesStructure(savedLayout.mainWindows.first().multiSplitterLayout));
+
+    anchor->setPosition(savedPos + 50);
+    QCOMPARE(dock1->frame()->width(), item1->width());
+
+    QVERIFY(saver.restoreLayout(saved));
+    QVERIFY(anchor);
+    QCOMPARE(anchor->position(), savedPos);
+    QCOMPARE(dock1->frame(), frame1.data());
+    QCOMPARE(dock2->frame(), frame2.data());
+    QVERIFY(dock1->isVisible());
+    QVERIFY(dock2->isVisible());
+    QVERIFY(saver.restoredDockWidgets().contains(dock1));
+    QVERIFY(layout->checkSanity());
+
+    // A different structure rebuilds the layout, but keeps the frames whose dock widgets didn't change
+    dock2->close();
+    QTRY_VERIFY(!frame2);
+    QVERIFY(!layout->matchesStructure(savedLayout.mainWindows.first().multiSplitterLayout));
+    QVERIFY(saver.restoreLayout(saved));
+    QVERIFY(dock2->isVisible());
+    QCOMPARE(dock2->window(), m.get());
+    QCOMPARE(dock1->frame(), frame1.data());
+    QVERIFY(dock1->isVisible());
+    QCOMPARE(frame1->geometry(), layout->itemForFrame(frame1)->geometry());
+    QCOMPARE(layout->count(), 2);
+    QVERIFY(layout->checkSanity());
+
+    // A frame whose dock widgets changed isn't kept
+    auto dock3 = createDockWidget("3", new QPushButton("3"));
+    dock1->addDockWidgetAsTab(dock3);
+    QVERIFY(saver.restoreLayout(saved));
+    QVERIFY(dock1->isVisible());
+    QVERIFY(dock1->frame() != frame1.data());
+    QCOMPARE(dock1->frame()->dockWidgetCount(), 1);
+    QVERIFY(!dock3->isVisible());
+    QTRY_VERIFY(!frame1);
+    QVERIFY(layout->checkSanity());
+    delete dock3;
+
+    // Frames in floating windows are kept too, even though the floating window is recreated
+    auto dock4 = createDockWidget("4", new QPushButton("4"));
+    QVERIFY(dock4->isFloating());
+    QPointer<Frame> frame4 = dock4->frame();
+    const QByteArray savedWithFloating = saver.serializeLayout();
+    dock1->close();
+    QVERIFY(saver.restoreLayout(savedWithFloating));
+    QVERIFY(dock1->isVisible());
+    QVERIFY(dock4->isVisible());
+    QVERIFY(dock4->isFloating());
+    QCOMPARE(dock4->frame(), frame4.data());
+    QCOMPARE(frame4->dockWidgetCount(), 1);
+    QVERIFY(layout->checkSanity());
+    delete dock4->window();
+}
+
+void TestDocks::tst_restoreBinary()
+{
+    // Tests that the binary format holds the same information as the JSON one, and can be restored
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    auto dock3 = createDockWidget("3", new QPushButton("3"));
+    auto dock4 = createDockWidget("4", new QPushButton("4"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    dock1->addDockWidgetAsTab(dock3);
+    dock2->close(); // leaves a placeholder
+    dock4->setFloating(true);
+    auto layout = m->multiSplitterLayout();
+
+    LayoutSaver saver;
+    const QByteArray json = saver.serializeLayout(LayoutSaver::Format_Json);
+    const QByteArray binary = saver.serializeLayout(LayoutSaver::Format_Binary);
+    QVERIFY(!LayoutSaver::Layout::isBinary(json));
+    QVERIFY(LayoutSaver::Layout::isBinary(binary));
+    QVERIFY(binary.size() < json.size());
+
+    {
+        LayoutSaver::Layout fromJson;
+        QVERIFY(fromJson.fromJson(json));
+        LayoutSaver::Layout fromBinary;
+        QVERIFY(fromBinary.fromBinary(binary));
+        QCOMPARE(fromBinary.toJson(), fromJson.toJson());
+        QCOMPARE(fromBinary.toBinary(), binary);
+    }
+
+    {
+        // Truncated data is rejected
+        SetExpectedWarning expectedWarning("Corrupt binary layout");
+        LayoutSaver::Layout truncated;
+        QVERIFY(!truncated.fromBinary(binary.left(binary.size() / 2)));
+    }
+
+    dock1->close();
+    dock2->show();
+    dock4->close();
+
+    QVERIFY(saver.restoreLayout(binary));
+    QVERIFY(dock1->isVisible());
+    QVERIFY(!dock2->isVisible());
+    QVERIFY(dock3->isVisible());
+    QVERIFY(dock4->isFloating());
+    QCOMPARE(dock1->frame(), dock3->frame());
+    QCOMPARE(layout->placeholderCount(), 1);
+    QVERIFY(layout->checkSanity());
+
+    delete dock4->window();
+}
+
+void TestDocks::tst_restoreFromFileAsync()
+{
+    // Tests that the file is parsed in a worker thread and then restored in the GUI thread
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    auto layout = m->multiSplitterLayout();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath(QStringLiteral("layout_async.json"));
+
+    LayoutSaver saver;
+    QVERIFY(saver.saveToFile(filename, LayoutSaver::Format_Binary));
+
+    // Parsing alone doesn't touch the windows
+    const std::shared_ptr<LayoutSaver::Layout> parsed = LayoutSaver::parseLayoutFile(filename);
+    QVERIFY(parsed);
+    QCOMPARE(parsed->mainWindows.size(), 1);
+    QVERIFY(dock2->isVisible());
+
+    dock2->close();
+
+    int numCallbacks = 0;
+    bool result = false;
+    bool calledInGuiThread = false;
+    QObject context;
+    saver.restoreFromFileAsync(filename, &context, [&] (bool success) {
+        calledInGuiThread = QThread::currentThread() == qApp->thread();
+        result = success;
+        numCallbacks++;
+    });
+
+    QTRY_COMPARE(numCallbacks, 1);
+    QVERIFY(calledInGuiThread);
+    QVERIFY(result);
+    QVERIFY(dock1->isVisible());
+    QVERIFY(dock2->isVisible());
+    QCOMPARE(layout->count(), 2);
+    QVERIFY(layout->checkSanity());
+
+    // Invalid files fail without touching the layout
+    {
+        SetExpectedWarning expectedWarning("Failed to open");
+        numCallbacks = 0;
+        saver.restoreFromFileAsync(dir.filePath(QStringLiteral("does-not-exist.json")), &context, [&] (bool success) {
+            result = success;
+            numCallbacks++;
+        });
+        QTRY_COMPARE(numCallbacks, 1);
+        QVERIFY(!result);
+        QCOMPARE(layout->count(), 2);
+    }
+
+    // A null context is refused, instead of silently never calling back
+    {
+        SetExpectedWarning expectedWarning("context can't be null");
+        numCallbacks = 0;
+        saver.restoreFromFileAsync(filename, nullptr, [&] (bool) { numCallbacks++; });
+        QTest::qWait(100);
+        QCOMPARE(numCallbacks, 0);
+    }
+}
+
+void TestDocks::tst_serializeCache()
+{
+    // Tests that serializing an unchanged layout reuses the previous snapshot, and that changes invalidate it
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(QSize(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("1", new QPushButton("1"));
+    auto dock2 = createDockWidget("2", new QPushButton("2"));
+    auto dock3 = createDockWidget("3", new QPushButton("3"));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    auto layout = m->multiSplitterLayout();
+
+    auto isShared = [] (const LayoutSaver::MultiSplitterLayout &a, const LayoutSaver::MultiSplitterLayout &b) {
+        return a.items.constData() == b.items.constData() && a.anchors.constData() == b.anchors.constData();
+    };
+
+    const LayoutSaver::MultiSplitterLayout s1 = layout->serialize();
+    QVERIFY(isShared(s1, layout->serialize()));
+
+    // Moving a separator
+    Anchor *anchor = layout->anchors(Qt::Vertical, /*includeStatic=*/ false).first();
+    anchor->setPosition(anchor->position() + 20);
+    const LayoutSaver::MultiSplitterLayout s2 = layout->serialize();
+    QVERIFY(!isShared(s1, s2));
+    QVERIFY(isShared(s2, layout->serialize()));
+
+    // Adding a tab, then changing the current one
+    dock2->addDockWidgetAsTab(dock3);
+    const LayoutSaver::MultiSplitterLayout s3 = layout->serialize();
+    QVERIFY(!isShared(s2, s3));
+    dock2->frame()->setCurrentTabIndex(0);
+    const LayoutSaver::MultiSplitterLayout s4 = layout->serialize();
+    QVERIFY(!isShared(s3, s4));
+
+    // Resizing the window
+    m->resize(m->size() + QSize(50, 50));
+    QTRY_VERIFY(!isShared(s4, layout->serialize()));
+
+    // The snapshot is always what a full serialization would produce
+    LayoutSaver saver;
+    const QByteArray saved = saver.serializeLayout();
+    layout->invalidateSerializeCache();
+    QCOMPARE(saver.serializeLayout(), saved);
+
+    // The encoded forms are cached along with the snapshot
+    const LayoutSaver::MultiSplitterLayout s5 = layout->serialize();
+    QVERIFY(s5.encodingCache);
+    const QByteArray savedBinary = saver.serializeLayout(LayoutSaver::Format_Binary);
+    QCOMPARE(saver.serializeLayout(), saved);
+    QVERIFY(!s5.encodingCache->variantMap.isEmpty());
+    QVERIFY(!s5.encodingCache->binary.isEmpty());
+    QCOMPARE(layout->serialize().encodingCache, s5.encodingCache);
+
+    // And produce the same output as encoding from scratch
+    layout->invalidateSerializeCache();
+    QVERIFY(layout->serialize().encodingCache != s5.encodingCache);
+    QCOMPARE(saver.serializeLayout(LayoutSaver::Format_Binary), savedBinary);
+    QCOMPARE(saver.serializeLayout(), saved);
+}
+
 void TestDocks::tst_resizeWindow_data()
 {
     QTest::addColumn<bool>("doASaveRestore");
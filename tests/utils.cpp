@@ -264,6 +264,8 @@ void KDDockWidgets::Tests::drag(QWidget *sourceWidget, QPoint pressGlobalPos, QP
     pressGlobalPos = sourceWidget->mapToGlobal(QPoint(10, 10));
     if (buttonActions & ButtonAction_Release)
         releaseOn(globalDest, sourceWidget);
+    else
+        QTest::qWait(Config::self().dragHoverInterval() + 1); // So the coalesced hover runs and the drop indicators are up to date
 }
 
 void KDDockWidgets::Tests::drag(QWidget *sourceWidget, QPoint globalDest, ButtonActions buttonActions)